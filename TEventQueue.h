@@ -0,0 +1,92 @@
+#ifndef T_EVENT_QUEUE_H
+#define T_EVENT_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-size lock-free multi-producer/single-consumer queue.
+// Producers (Z-Wave stack callbacks, possibly in different contexts) never block: a slot is reserved by a
+// compare-and-swap of Head, and if the queue is full the event is dropped and counted.
+// Each slot carries a sequence number telling whether it is free, written or being written,
+// so the consumer (main loop) pops the events in the order their slots were reserved
+template <typename T, size_t Size> class TEventQueue
+{
+    static_assert((Size & (Size - 1)) == 0, "Queue size must be a power of two");
+
+public:
+    TEventQueue(): Head(0), Tail(0), Dropped(0), Coalesced(0)
+    {
+        for (size_t i = 0; i < Size; i++) {
+            Slots[i].Sequence = i;
+        }
+    }
+
+    // Producer side, safe for concurrent producers
+    bool Push(const T& event)
+    {
+        uint32_t head = __atomic_load_n(&Head, __ATOMIC_RELAXED);
+        for (;;) {
+            Slot& slot = Slots[head & (Size - 1)];
+            int32_t state = (int32_t)(__atomic_load_n(&slot.Sequence, __ATOMIC_ACQUIRE) - head);
+            if (state < 0) {
+                // The consumer hasn't freed the slot yet
+                __atomic_fetch_add(&Dropped, 1, __ATOMIC_RELAXED);
+                return false;
+            }
+            if (state > 0) {
+                // Another producer took the slot, head is reloaded
+                head = __atomic_load_n(&Head, __ATOMIC_RELAXED);
+                continue;
+            }
+            if (__atomic_compare_exchange_n(&Head, &head, head + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                slot.Event = event;
+                __atomic_store_n(&slot.Sequence, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+    }
+
+    // Consumer side
+    bool Pop(T& event)
+    {
+        Slot& slot = Slots[Tail & (Size - 1)];
+        if (__atomic_load_n(&slot.Sequence, __ATOMIC_ACQUIRE) != Tail + 1) {
+            // Empty, or the producer is still writing the event
+            return false;
+        }
+        event = slot.Event;
+        __atomic_store_n(&slot.Sequence, Tail + Size, __ATOMIC_RELEASE);
+        Tail++;
+        return true;
+    }
+
+    // Consumer side: events merged into later ones without a separate effect
+    void AddCoalesced(uint32_t count)
+    {
+        Coalesced += count;
+    }
+
+    uint32_t GetDropped() const
+    {
+        return __atomic_load_n(&Dropped, __ATOMIC_RELAXED);
+    }
+
+    uint32_t GetCoalesced() const
+    {
+        return Coalesced;
+    }
+
+private:
+    struct Slot
+    {
+        T Event;
+        uint32_t Sequence; // Index of the slot - free, index + 1 - written
+    };
+    Slot Slots[Size];
+    uint32_t Head; // Next slot to reserve, shared by the producers
+    uint32_t Tail; // Written by the consumer only
+    uint32_t Dropped;
+    uint32_t Coalesced;
+};
+
+#endif // T_EVENT_QUEUE_H
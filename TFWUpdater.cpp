@@ -1,17 +1,37 @@
 #include "TFWUpdater.h"
+#include "CrcClass.h"
 #include "DebugOutput.h"
 #include "WbMsw.h"
+#include "WbMswImage.h"
+#include "WbMswRetention.h"
+
+#define WB_MSW_FIRMWARE_INFO_WORDS (WBMSW_FIRMWARE_INFO_SIZE / sizeof(uint16_t))
+#define WB_MSW_FIRMWARE_DATA_WORDS (WBMSW_FIRMWARE_DATA_SIZE / sizeof(uint16_t))
 
 TFWUpdater::TFWUpdater(TWBMSWSensor* wbMsw): WbMsw(wbMsw)
 {
     NewFirmware = false;
     FirmwareSize = 0;
+    Payload = NULL;
+    PayloadSize = 0;
+    Compression = WB_MSW_IMAGE_COMPRESSION_NONE;
+    ImageSize = 0;
+    ImageVersion = 0;
+    ReadOffset = 0;
+    Resume = false;
+    UpdateState = TFWUpdater::State::IDLE;
+    Block = 0;
+    BlocksCount = 0;
+    BlockAttempts = 0;
+    StateStartTime = 0;
+    LastPollTime = 0;
 }
 
 void TFWUpdater::NewFirmwareNotification(uint32_t newFirmwareSize)
 {
     FirmwareSize = newFirmwareSize;
     NewFirmware = true;
+    Resume = false;
 }
 
 bool TFWUpdater::GetFirmvareVersion(uint16_t& version)
@@ -24,11 +44,299 @@ bool TFWUpdater::CheckNewFirmwareAvailable()
     return NewFirmware;
 }
 
-bool TFWUpdater::UpdateFirmware()
+// Checks whether an update was interrupted by a Z-Uno reset. The sensor is left in its bootloader then,
+// so it doesn't answer the bus scan and the update must be resumed with the saved modbus address
+bool TFWUpdater::RestoreProgress(uint8_t& modbusAddress)
 {
-    if (WbMsw->FwUpdate((uint16_t*)WB_MSW_UPDATE_ADDRESS, FirmwareSize / sizeof(uint16_t))) {
-        NewFirmware = false;
+    uint32_t state = WbMswRetentionGet(WB_MSW_RETENTION_FW_STATE);
+    if ((state >> 8) != WB_MSW_RETENTION_FW_MAGIC) {
+        return false;
+    }
+    modbusAddress = state & 0xFF;
+    FirmwareSize = WbMswRetentionGet(WB_MSW_RETENTION_FW_SIZE);
+    Block = WbMswRetentionGet(WB_MSW_RETENTION_FW_BLOCK);
+    NewFirmware = true;
+    Resume = true;
+    DEBUG("Resume firmware update from block ");
+    DEBUG(Block);
+    DEBUG("\n");
+    return true;
+}
+
+bool TFWUpdater::IsUpdating() const
+{
+    return UpdateState != TFWUpdater::State::IDLE;
+}
+
+// Percent of the transferred data blocks
+uint8_t TFWUpdater::GetProgress() const
+{
+    if (BlocksCount == 0) {
+        return 0;
+    }
+    return (Block * 100) / BlocksCount;
+}
+
+void TFWUpdater::SaveProgress(uint32_t block)
+{
+    // The bootloader starts the new firmware after the last block, nothing is left to resume then
+    if (block >= BlocksCount) {
+        ClearProgress();
+        return;
+    }
+    WbMswRetentionSet(WB_MSW_RETENTION_FW_BLOCK, block);
+    WbMswRetentionSet(WB_MSW_RETENTION_FW_SIZE, FirmwareSize);
+    WbMswRetentionSet(WB_MSW_RETENTION_FW_STATE, (WB_MSW_RETENTION_FW_MAGIC << 8) | WbMsw->GetModbusAddress());
+}
+
+void TFWUpdater::ClearProgress()
+{
+    WbMswRetentionSet(WB_MSW_RETENTION_FW_STATE, 0);
+}
+
+void TFWUpdater::SetState(TFWUpdater::State state)
+{
+    UpdateState = state;
+    StateStartTime = millis();
+    LastPollTime = StateStartTime;
+}
+
+// Limits the sensor polling rate while waiting for the bootloader or the new firmware
+bool TFWUpdater::PollPeriodPassed()
+{
+    if (millis() - LastPollTime < WB_MSW_BOOTLOADER_POLL_PERIOD_MS) {
+        return false;
+    }
+    LastPollTime = millis();
+    return true;
+}
+
+TFWUpdater::Result TFWUpdater::Fail()
+{
+    UpdateState = TFWUpdater::State::IDLE;
+    return TFWUpdater::Result::FW_UPDATE_ERROR;
+}
+
+// Validates the received image in flash before the sensor is switched to the bootloader,
+// so that a damaged image doesn't take the sensor offline
+bool TFWUpdater::CheckImage()
+{
+    const uint8_t* ota = (const uint8_t*)WB_MSW_UPDATE_ADDRESS;
+    const WbMswImageHeader_t* header = (const WbMswImageHeader_t*)ota;
+
+    if (FirmwareSize >= sizeof(WbMswImageHeader_t) && header->Magic == WB_MSW_IMAGE_MAGIC) {
+        if (CrcClass::crc16_modbus(header, offsetof(WbMswImageHeader_t, HeaderCrc)) != header->HeaderCrc) {
+            DEBUG("*** ERROR Firmware header CRC mismatch\n");
+            return false;
+        }
+        bool compressionSupported =
+            (header->Compression == WB_MSW_IMAGE_COMPRESSION_NONE && header->PayloadSize == header->ImageSize) ||
+            (header->Compression == WB_MSW_IMAGE_COMPRESSION_HEATSHRINK &&
+             header->Flags == WB_MSW_IMAGE_HEATSHRINK_FLAGS);
+        if (header->Format != WB_MSW_IMAGE_FORMAT || !compressionSupported ||
+            header->PayloadSize > FirmwareSize - sizeof(WbMswImageHeader_t))
+        {
+            DEBUG("*** ERROR Unsupported firmware header\n");
+            return false;
+        }
+        // Flash is memory mapped, so the payload is checked in one pass without copying
+        if (CrcClass::crc16_modbus(ota + sizeof(WbMswImageHeader_t), header->PayloadSize) != header->PayloadCrc) {
+            DEBUG("*** ERROR Firmware CRC mismatch\n");
+            return false;
+        }
+        Payload = ota + sizeof(WbMswImageHeader_t);
+        PayloadSize = header->PayloadSize;
+        Compression = header->Compression;
+        ImageSize = header->ImageSize;
+        ImageVersion = header->Version;
+    } else {
+        // Raw .wbfw image without a header, only its size can be checked
+        Payload = ota;
+        PayloadSize = FirmwareSize;
+        Compression = WB_MSW_IMAGE_COMPRESSION_NONE;
+        ImageSize = FirmwareSize;
+        ImageVersion = 0;
+    }
+
+    uint32_t length = ImageSize / sizeof(uint16_t); // in words
+    if ((ImageSize % sizeof(uint16_t)) || length < WB_MSW_FIRMWARE_INFO_WORDS ||
+        (length - WB_MSW_FIRMWARE_INFO_WORDS) % WB_MSW_FIRMWARE_DATA_WORDS)
+    {
+        DEBUG("*** ERROR Wrong firmware size\n");
+        return false;
+    }
+    return true;
+}
+
+void TFWUpdater::RewindImage()
+{
+    ReadOffset = 0;
+    if (Compression == WB_MSW_IMAGE_COMPRESSION_HEATSHRINK) {
+        Decoder.Reset(Payload, PayloadSize);
+    }
+}
+
+// Reads the next part of the .wbfw file, unpacking it if needed
+bool TFWUpdater::ReadImage(uint16_t* buffer, size_t size)
+{
+    if (ReadOffset + size > ImageSize) {
+        return false;
+    }
+    ReadOffset += size;
+    if (Compression == WB_MSW_IMAGE_COMPRESSION_HEATSHRINK) {
+        if (!Decoder.Read((uint8_t*)buffer, size)) {
+            DEBUG("*** ERROR Broken compressed firmware\n");
+            return false;
+        }
         return true;
     }
-    return false;
+    memcpy(buffer, Payload + ReadOffset - size, size);
+    return true;
+}
+
+// Prepares the info block for a new bootloader session
+bool TFWUpdater::RestartUpload()
+{
+    RewindImage();
+    Block = 0;
+    SetState(TFWUpdater::State::START);
+    return ReadImage(InfoData, WBMSW_FIRMWARE_INFO_SIZE);
+}
+
+// Checks the received image and prepares the transfer. The transfer itself is done by ProcessUpdate()
+bool TFWUpdater::StartUpdate()
+{
+    if (!CheckImage()) {
+        NewFirmware = false;
+        ClearProgress();
+        return false;
+    }
+    DEBUG("FW size: ");
+    DEBUG(ImageSize);
+    DEBUG("\n");
+
+    BlocksCount = (ImageSize / sizeof(uint16_t) - WB_MSW_FIRMWARE_INFO_WORDS) / WB_MSW_FIRMWARE_DATA_WORDS;
+    BlockAttempts = 0;
+    bool resume = Resume && Block < BlocksCount;
+    Resume = false;
+    if (!resume) {
+        return RestartUpload();
+    }
+    // Continue the bootloader session if it survived the reset. The blocks sent before are unpacked again
+    // to restore the decoder state, it takes much less time than their transfer
+    RewindImage();
+    bool restored = ReadImage(InfoData, WBMSW_FIRMWARE_INFO_SIZE);
+    for (uint32_t i = 0; restored && i <= Block; i++) {
+        restored = ReadImage(BlockData, WBMSW_FIRMWARE_DATA_SIZE);
+    }
+    if (!restored) {
+        return RestartUpload();
+    }
+    SetState(TFWUpdater::State::RESUME);
+    return true;
+}
+
+// Drops the received image after the update has failed several times
+void TFWUpdater::CancelUpdate()
+{
+    UpdateState = TFWUpdater::State::IDLE;
+    NewFirmware = false;
+    Resume = false;
+    ClearProgress();
+}
+
+// Makes one step of the update, so that the caller's loop keeps running during the transfer.
+// Every call makes at most one modbus transaction
+TFWUpdater::Result TFWUpdater::ProcessUpdate()
+{
+    switch (UpdateState) {
+        case TFWUpdater::State::IDLE:
+            return TFWUpdater::Result::FW_UPDATE_IDLE;
+
+        case TFWUpdater::State::RESUME:
+            if (WbMsw->FwWriteData(BlockData)) {
+                Block++;
+                SaveProgress(Block);
+                SetState(TFWUpdater::State::WRITE_DATA);
+                if (Block < BlocksCount && !ReadImage(BlockData, WBMSW_FIRMWARE_DATA_SIZE)) {
+                    return Fail();
+                }
+            } else if (!RestartUpload()) {
+                return Fail();
+            }
+            break;
+
+        case TFWUpdater::State::START:
+            // The sensor doesn't answer the bus scan from now on, so its address is saved before the switch
+            SaveProgress(Block);
+            if (!WbMsw->SetFwMode()) {
+                // The sensor may already be in the bootloader, it is checked by the info block write
+                DEBUG("Can't switch to bootloader, probably already there\n");
+            }
+            SetState(TFWUpdater::State::WAIT_BOOTLOADER);
+            break;
+
+        case TFWUpdater::State::WAIT_BOOTLOADER:
+            if (!PollPeriodPassed()) {
+                break;
+            }
+            if (WbMsw->FwWriteInfo(InfoData)) {
+                DEBUG("Write info\n");
+                SetState(TFWUpdater::State::WRITE_DATA);
+                if (!ReadImage(BlockData, WBMSW_FIRMWARE_DATA_SIZE)) {
+                    return Fail();
+                }
+            } else if (millis() - StateStartTime > WB_MSW_BOOTLOADER_TIMEOUT_MS) {
+                DEBUG("*** ERROR Bootloader is not ready\n");
+                return Fail();
+            }
+            break;
+
+        case TFWUpdater::State::WRITE_DATA:
+            if (Block == BlocksCount) {
+                ClearProgress();
+                DEBUG("Write finish\n");
+                SetState(TFWUpdater::State::WAIT_FIRMWARE);
+                break;
+            }
+            if (WbMsw->FwWriteData(BlockData)) {
+                Block++;
+                BlockAttempts = 0;
+                // Only acknowledged blocks are counted, so a resumed session continues with the next one
+                SaveProgress(Block);
+                DEBUG("FW progress: ");
+                DEBUG(GetProgress());
+                DEBUG("%\n");
+                if (Block < BlocksCount && !ReadImage(BlockData, WBMSW_FIRMWARE_DATA_SIZE)) {
+                    return Fail();
+                }
+            } else if (++BlockAttempts >= WB_MSW_FIRMWARE_BLOCK_RETRIES) {
+                DEBUG("*** ERROR Unsuccesful data block write\n");
+                return Fail();
+            }
+            break;
+
+        // The bootloader starts the new firmware after the last block, the update is verified by reading its version
+        case TFWUpdater::State::WAIT_FIRMWARE: {
+            if (!PollPeriodPassed()) {
+                break;
+            }
+            uint16_t version;
+            if (WbMsw->GetFwVersion(version)) {
+                if (ImageVersion != 0 && version != ImageVersion) {
+                    DEBUG("*** ERROR New firmware version mismatch\n");
+                    return Fail();
+                }
+                UpdateState = TFWUpdater::State::IDLE;
+                NewFirmware = false;
+                return TFWUpdater::Result::FW_UPDATE_SUCCESS;
+            }
+            if (millis() - StateStartTime > WB_MSW_FIRMWARE_START_TIMEOUT_MS) {
+                DEBUG("*** ERROR New firmware doesn't start\n");
+                return Fail();
+            }
+            break;
+        }
+    }
+    return TFWUpdater::Result::FW_UPDATE_IN_PROGRESS;
 }
@@ -1,17 +1,68 @@
 #include "Arduino.h"
+#include "THeatshrinkDecoder.h"
 #include "TWBMSWSensor.h"
 
 class TFWUpdater
 {
 public:
+    enum class Result
+    {
+        FW_UPDATE_IDLE,
+        FW_UPDATE_IN_PROGRESS,
+        FW_UPDATE_SUCCESS,
+        FW_UPDATE_ERROR
+    };
+
     TFWUpdater(TWBMSWSensor* wbMsw);
     void NewFirmwareNotification(uint32_t newFirmwareSize);
     bool GetFirmvareVersion(uint16_t& version);
     bool CheckNewFirmwareAvailable();
-    bool UpdateFirmware();
+    bool RestoreProgress(uint8_t& modbusAddress);
+    bool StartUpdate();
+    void CancelUpdate();
+    TFWUpdater::Result ProcessUpdate();
+    bool IsUpdating() const;
+    uint8_t GetProgress() const;
 
 private:
+    enum class State
+    {
+        IDLE,
+        RESUME,
+        START,
+        WAIT_BOOTLOADER,
+        WRITE_DATA,
+        WAIT_FIRMWARE
+    };
+
     TWBMSWSensor* WbMsw;
     uint32_t FirmwareSize;
+    const uint8_t* Payload; // Data following the header of the received OTA image
+    uint32_t PayloadSize;
+    uint8_t Compression;
+    uint32_t ImageSize;    // .wbfw file size
+    uint16_t ImageVersion; // Expected firmware version (major << 8 | minor), 0 if unknown
+    uint32_t ReadOffset;   // in the .wbfw file
+    THeatshrinkDecoder Decoder;
+    // Blocks are sent from RAM, as compressed images are unpacked on the fly
+    uint16_t InfoData[WBMSW_FIRMWARE_INFO_SIZE / sizeof(uint16_t)];
+    uint16_t BlockData[WBMSW_FIRMWARE_DATA_SIZE / sizeof(uint16_t)];
     bool NewFirmware;
-};
\ No newline at end of file
+    bool Resume;
+    TFWUpdater::State UpdateState;
+    uint32_t Block;
+    uint32_t BlocksCount;
+    uint8_t BlockAttempts;
+    uint32_t StateStartTime;
+    uint32_t LastPollTime;
+
+    bool CheckImage();
+    void RewindImage();
+    bool ReadImage(uint16_t* buffer, size_t size);
+    bool RestartUpload();
+    bool PollPeriodPassed();
+    void SetState(TFWUpdater::State state);
+    TFWUpdater::Result Fail();
+    void SaveProgress(uint32_t block);
+    void ClearProgress();
+};
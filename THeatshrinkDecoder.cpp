@@ -0,0 +1,71 @@
+#include "THeatshrinkDecoder.h"
+#include <string.h>
+
+#define HEATSHRINK_WINDOW_MASK ((1 << HEATSHRINK_WINDOW_BITS) - 1)
+
+THeatshrinkDecoder::THeatshrinkDecoder()
+{
+    Reset(NULL, 0);
+}
+
+void THeatshrinkDecoder::Reset(const uint8_t* input, uint32_t inputSize)
+{
+    Input = input;
+    InputSize = inputSize;
+    InputBitPosition = 0;
+    // References before the start of the data read zeroes, as in the reference implementation
+    memset(Window, 0, sizeof(Window));
+    WindowHead = 0;
+    BackrefOffset = 0;
+    BackrefCount = 0;
+}
+
+bool THeatshrinkDecoder::GetBits(uint8_t count, uint16_t& bits)
+{
+    if (InputBitPosition + count > InputSize * 8) {
+        return false;
+    }
+    bits = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t byte = Input[InputBitPosition >> 3];
+        bits = (bits << 1) | ((byte >> (7 - (InputBitPosition & 0x7))) & 0x1);
+        InputBitPosition++;
+    }
+    return true;
+}
+
+bool THeatshrinkDecoder::Read(uint8_t* output, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        if (BackrefCount == 0) {
+            uint16_t literal;
+            if (!GetBits(1, literal)) {
+                return false;
+            }
+            if (!literal) {
+                uint16_t index;
+                uint16_t count;
+                if (!GetBits(HEATSHRINK_WINDOW_BITS, index) || !GetBits(HEATSHRINK_LOOKAHEAD_BITS, count)) {
+                    return false;
+                }
+                BackrefOffset = index + 1;
+                BackrefCount = count + 1;
+            }
+        }
+        uint8_t byte;
+        if (BackrefCount) {
+            byte = Window[(WindowHead - BackrefOffset) & HEATSHRINK_WINDOW_MASK];
+            BackrefCount--;
+        } else {
+            uint16_t literal;
+            if (!GetBits(8, literal)) {
+                return false;
+            }
+            byte = literal;
+        }
+        Window[WindowHead] = byte;
+        WindowHead = (WindowHead + 1) & HEATSHRINK_WINDOW_MASK;
+        output[i] = byte;
+    }
+    return true;
+}
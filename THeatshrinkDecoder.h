@@ -0,0 +1,35 @@
+#ifndef T_HEATSHRINK_DECODER_H
+#define T_HEATSHRINK_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming decoder of the heatshrink (LZSS) format with static buffers.
+// The compressed data is read in place from the memory mapped flash, only the window is kept in RAM.
+// The stream is a sequence of MSB first bit fields:
+//  1 + 8 bit literal byte,
+//  0 + WINDOW_BITS (offset - 1) + LOOKAHEAD_BITS (length - 1) back reference to the decoded data
+#define HEATSHRINK_WINDOW_BITS 8
+#define HEATSHRINK_LOOKAHEAD_BITS 4
+
+class THeatshrinkDecoder
+{
+public:
+    THeatshrinkDecoder();
+    void Reset(const uint8_t* input, uint32_t inputSize);
+    // Fails if the compressed data ends before the requested size is decoded
+    bool Read(uint8_t* output, size_t size);
+
+private:
+    const uint8_t* Input;
+    uint32_t InputSize;
+    uint32_t InputBitPosition;
+    uint8_t Window[1 << HEATSHRINK_WINDOW_BITS];
+    uint16_t WindowHead;
+    uint16_t BackrefOffset;
+    uint8_t BackrefCount;
+
+    bool GetBits(uint8_t count, uint16_t& bits);
+};
+
+#endif // T_HEATSHRINK_DECODER_H
@@ -0,0 +1,128 @@
+#include "TReportQueue.h"
+
+TReportQueue::TReportQueue(): Sequence(0), Deferred(0), Dropped(0)
+{
+    for (size_t i = 0; i < WB_MSW_REPORT_QUEUE_SIZE; i++) {
+        Entries[i].EntryKind = TReportQueue::Kind::NONE;
+    }
+}
+
+bool TReportQueue::Add(TReportQueue::Kind kind, uint8_t target, uint8_t value, TReportQueue::Priority priority)
+{
+    TReportQueue::Entry* freeEntry = NULL;
+    for (size_t i = 0; i < WB_MSW_REPORT_QUEUE_SIZE; i++) {
+        TReportQueue::Entry& entry = Entries[i];
+        if (entry.EntryKind == kind && entry.Target == target) {
+            // The pending entry keeps its place in the queue, but sends the newer value
+            entry.Value = value;
+            if (priority > entry.EntryPriority) {
+                entry.EntryPriority = priority;
+            }
+            return true;
+        }
+        if (entry.EntryKind == TReportQueue::Kind::NONE && freeEntry == NULL) {
+            freeEntry = &entry;
+        }
+    }
+    if (freeEntry == NULL) {
+        Dropped++;
+        return false;
+    }
+    freeEntry->EntryKind = kind;
+    freeEntry->EntryPriority = priority;
+    freeEntry->Target = target;
+    freeEntry->Value = value;
+    freeEntry->Deferred = false;
+    freeEntry->Sequence = Sequence++;
+    return true;
+}
+
+bool TReportQueue::AddReport(uint8_t channelServerNumber, TReportQueue::Priority priority)
+{
+    return Add(TReportQueue::Kind::REPORT, channelServerNumber, 0, priority);
+}
+
+bool TReportQueue::AddBasicSet(uint8_t groupIndex, uint8_t value)
+{
+    return Add(TReportQueue::Kind::BASIC_SET, groupIndex, value, TReportQueue::Priority::BASIC);
+}
+
+// framesPerMinute - 0 disables the limit
+void TReportQueue::SetRate(uint32_t framesPerMinute, uint32_t burst)
+{
+    Budget.SetRate(framesPerMinute, burst, millis());
+}
+
+void TReportQueue::SetChannelRate(uint8_t channelServerNumber, uint32_t framesPerMinute, uint32_t burst)
+{
+    if (channelServerNumber >= WB_MSW_SERVER_CHANNELS_MAX) {
+        return;
+    }
+    ChannelBudgets[channelServerNumber].SetRate(framesPerMinute, burst, millis());
+}
+
+// Only analog reports wait for the budgets, the rest may overdraw them
+bool TReportQueue::CanSend(const TReportQueue::Entry& entry, uint32_t currentTime)
+{
+    if (entry.EntryPriority != TReportQueue::Priority::ANALOG) {
+        return true;
+    }
+    if (!Budget.Check(1, currentTime)) {
+        return false;
+    }
+    return entry.Target >= WB_MSW_SERVER_CHANNELS_MAX || ChannelBudgets[entry.Target].Check(1, currentTime);
+}
+
+// Sends pending entries until nothing more fits into the budgets or the radio doesn't accept more packets
+void TReportQueue::Process()
+{
+    uint32_t currentTime = millis();
+    while (true) {
+        TReportQueue::Entry* next = NULL;
+        for (size_t i = 0; i < WB_MSW_REPORT_QUEUE_SIZE; i++) {
+            TReportQueue::Entry& entry = Entries[i];
+            if (entry.EntryKind == TReportQueue::Kind::NONE) {
+                continue;
+            }
+            if (!CanSend(entry, currentTime)) {
+                if (!entry.Deferred) {
+                    entry.Deferred = true;
+                    Deferred++;
+                }
+                continue;
+            }
+            if (next == NULL || entry.EntryPriority > next->EntryPriority ||
+                (entry.EntryPriority == next->EntryPriority && (int32_t)(entry.Sequence - next->Sequence) < 0))
+            {
+                next = &entry;
+            }
+        }
+        if (next == NULL) {
+            return;
+        }
+        ZunoError_t result;
+        if (next->EntryKind == TReportQueue::Kind::REPORT) {
+            result = zunoSendReport(next->Target);
+        } else {
+            result = zunoSendToGroupSetValueCommand(next->Target, next->Value);
+        }
+        if (result != ZunoErrorOk) {
+            return;
+        }
+        Budget.Take(1);
+        if (next->EntryKind == TReportQueue::Kind::REPORT && next->Target < WB_MSW_SERVER_CHANNELS_MAX) {
+            ChannelBudgets[next->Target].Take(1);
+        }
+        next->EntryKind = TReportQueue::Kind::NONE;
+    }
+}
+
+uint32_t TReportQueue::GetDeferred() const
+{
+    return Deferred;
+}
+
+uint32_t TReportQueue::GetDropped() const
+{
+    return Dropped;
+}
\ No newline at end of file
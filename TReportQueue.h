@@ -0,0 +1,62 @@
+#ifndef T_REPORT_QUEUE_H
+#define T_REPORT_QUEUE_H
+
+#include "Arduino.h"
+#include "TTokenBucket.h"
+#include "WbMsw.h"
+
+// Pending reports to the controller and Basic Set commands to association groups.
+// There is at most one pending entry per channel and per group: a report always sends the current channel value,
+// and a newer Basic Set replaces the pending one. Entries are sent by priority, older first,
+// as long as the radio accepts them.
+// Every sent frame takes a token from the device budget, and a report also from its channel budget.
+// Analog reports over any of the budgets are deferred (coalesced in their entries), events and commands never wait
+class TReportQueue
+{
+public:
+    enum class Priority : uint8_t
+    {
+        ANALOG, // Slowly changing sensor values
+        BASIC,  // Basic Set commands to association groups
+        EVENT   // Motion and intrusion state changes
+    };
+
+    TReportQueue();
+    bool AddReport(uint8_t channelServerNumber, TReportQueue::Priority priority);
+    bool AddBasicSet(uint8_t groupIndex, uint8_t value);
+    void SetRate(uint32_t framesPerMinute, uint32_t burst);
+    void SetChannelRate(uint8_t channelServerNumber, uint32_t framesPerMinute, uint32_t burst);
+    void Process();
+    uint32_t GetDeferred() const;
+    uint32_t GetDropped() const;
+
+private:
+    enum class Kind : uint8_t
+    {
+        NONE,
+        REPORT,
+        BASIC_SET
+    };
+
+    struct Entry
+    {
+        TReportQueue::Kind EntryKind;
+        TReportQueue::Priority EntryPriority;
+        uint8_t Target; // Channel or group
+        uint8_t Value;  // Basic Set value
+        bool Deferred;  // Already counted as deferred
+        uint32_t Sequence;
+    };
+
+    TReportQueue::Entry Entries[WB_MSW_REPORT_QUEUE_SIZE];
+    uint32_t Sequence;
+    uint32_t Deferred;
+    uint32_t Dropped; // Entries refused as the queue was full
+    TTokenBucket Budget;
+    TTokenBucket ChannelBudgets[WB_MSW_SERVER_CHANNELS_MAX];
+
+    bool Add(TReportQueue::Kind kind, uint8_t target, uint8_t value, TReportQueue::Priority priority);
+    bool CanSend(const TReportQueue::Entry& entry, uint32_t currentTime);
+};
+
+#endif // T_REPORT_QUEUE_H
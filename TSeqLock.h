@@ -0,0 +1,61 @@
+#ifndef T_SEQ_LOCK_H
+#define T_SEQ_LOCK_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Single writer sequence lock over two copies of the value (latch).
+// While the writer updates one copy, readers are directed to the other one, so neither side ever blocks:
+// the writer is wait-free, and a reader retries only if the writer has completed a whole update meanwhile
+// (i.e. the reader was preempted by the writer). Both sides may run in different threads or handlers.
+// T must be trivially copyable
+template <typename T> class TSeqLock
+{
+public:
+    TSeqLock(): Sequence(0)
+    {
+        memset(Copies, 0, sizeof(Copies));
+    }
+
+    // Must be called from one thread only
+    void Write(const T& value)
+    {
+        uint32_t sequence = Sequence;
+        __atomic_thread_fence(__ATOMIC_RELEASE); // Previous update of Copies[1] completes before readers leave it
+        __atomic_store_n(&Sequence, sequence + 1, __ATOMIC_RELAXED); // Readers switch to Copies[1]
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(&Copies[0], &value, sizeof(T));
+        __atomic_store_n(&Sequence, sequence + 2, __ATOMIC_RELEASE); // Readers switch to Copies[0]
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(&Copies[1], &value, sizeof(T));
+    }
+
+    // Last written value, for the writer thread only
+    const T& Peek() const
+    {
+        return Copies[0];
+    }
+
+    // Returns the sequence number the value corresponds to
+    uint32_t Read(T& value) const
+    {
+        uint32_t sequence;
+        do {
+            sequence = __atomic_load_n(&Sequence, __ATOMIC_ACQUIRE);
+            memcpy(&value, &Copies[sequence & 0x1], sizeof(T));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while (sequence != __atomic_load_n(&Sequence, __ATOMIC_RELAXED));
+        return sequence;
+    }
+
+    uint32_t GetSequence() const
+    {
+        return __atomic_load_n(&Sequence, __ATOMIC_ACQUIRE);
+    }
+
+private:
+    uint32_t Sequence;
+    T Copies[2];
+};
+
+#endif // T_SEQ_LOCK_H
@@ -0,0 +1,85 @@
+#include "TSignalFilter.h"
+
+// Keeps the average update within 64 bits: 32 bits of the value difference, the fraction and the interval
+#define SIGNAL_FILTER_MAX_INTERVAL_MS (1 << (62 - 32 - SIGNAL_FILTER_FRACTION_BITS))
+
+TSignalFilter::TSignalFilter(): MedianSize(1), TimeConstantMs(0)
+{
+    Reset();
+}
+
+void TSignalFilter::Configure(uint8_t medianSize, uint32_t timeConstantMs)
+{
+    if (medianSize < 1) {
+        medianSize = 1;
+    }
+    if (medianSize > SIGNAL_FILTER_MEDIAN_MAX) {
+        medianSize = SIGNAL_FILTER_MEDIAN_MAX;
+    }
+    if (medianSize == MedianSize && timeConstantMs == TimeConstantMs) {
+        return;
+    }
+    MedianSize = medianSize;
+    TimeConstantMs = timeConstantMs;
+    Reset();
+}
+
+// Forgets the history, e.g. after the sensor was disconnected
+void TSignalFilter::Reset()
+{
+    SamplesCount = 0;
+    SamplesHead = 0;
+    Average = 0;
+    AverageTime = 0;
+    AverageInitialized = false;
+}
+
+// Median of the samples collected so far, up to MedianSize
+int32_t TSignalFilter::GetMedian(int32_t value)
+{
+    Samples[SamplesHead] = value;
+    SamplesHead = (SamplesHead + 1) % MedianSize;
+    if (SamplesCount < MedianSize) {
+        SamplesCount++;
+    }
+    int32_t sorted[SIGNAL_FILTER_MEDIAN_MAX];
+    for (uint8_t i = 0; i < SamplesCount; i++) {
+        int32_t sample = Samples[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > sample; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = sample;
+    }
+    return sorted[SamplesCount / 2];
+}
+
+int32_t TSignalFilter::Process(int32_t value, uint32_t currentTime)
+{
+    if (MedianSize > 1) {
+        value = GetMedian(value);
+    }
+    if (TimeConstantMs == 0) {
+        return value;
+    }
+    int64_t sample = (int64_t)value << SIGNAL_FILTER_FRACTION_BITS;
+    if (!AverageInitialized) {
+        Average = sample;
+        AverageInitialized = true;
+    } else {
+        // Discrete form of the first order low pass: weight = dt / (tau + dt).
+        // Longer intervals are scaled down together with the time constant, so the weight stays the same
+        int64_t interval = currentTime - AverageTime;
+        int64_t timeConstant = TimeConstantMs;
+        while (interval > SIGNAL_FILTER_MAX_INTERVAL_MS) {
+            interval >>= 1;
+            timeConstant >>= 1;
+        }
+        int64_t step = (sample - Average) * interval;
+        int64_t divider = timeConstant + interval;
+        // Rounded, so that the average reaches a constant input instead of stopping short of it
+        Average += (step >= 0 ? step + divider / 2 : step - divider / 2) / divider;
+    }
+    AverageTime = currentTime;
+    return (int32_t)((Average + (1 << (SIGNAL_FILTER_FRACTION_BITS - 1))) >> SIGNAL_FILTER_FRACTION_BITS);
+}
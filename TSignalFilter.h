@@ -0,0 +1,34 @@
+#ifndef T_SIGNAL_FILTER_H
+#define T_SIGNAL_FILTER_H
+
+#include <stdint.h>
+
+#define SIGNAL_FILTER_MEDIAN_MAX 5     // Largest median window
+#define SIGNAL_FILTER_FRACTION_BITS 16 // Fractional bits of the average
+
+// Integer filter chain of a sensor value: a median of the last samples rejects single spikes,
+// then an exponential moving average with a time constant smooths the noise.
+// The average weight follows the time between samples, so it doesn't depend on the poll period
+class TSignalFilter
+{
+public:
+    TSignalFilter();
+    // medianSize - 1 disables the median, timeConstantMs - 0 disables the average
+    void Configure(uint8_t medianSize, uint32_t timeConstantMs);
+    void Reset();
+    int32_t Process(int32_t value, uint32_t currentTime);
+
+private:
+    uint8_t MedianSize;
+    uint32_t TimeConstantMs;
+    int32_t Samples[SIGNAL_FILTER_MEDIAN_MAX]; // Ring buffer of the last samples
+    uint8_t SamplesCount;
+    uint8_t SamplesHead;
+    int64_t Average; // Fixed point with SIGNAL_FILTER_FRACTION_BITS
+    uint32_t AverageTime;
+    bool AverageInitialized;
+
+    int32_t GetMedian(int32_t value);
+};
+
+#endif // T_SIGNAL_FILTER_H
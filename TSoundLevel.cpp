@@ -0,0 +1,55 @@
+#include "TSoundLevel.h"
+#include "WbMswFixedPoint.h"
+
+#define SOUND_LEVEL_ENERGY_FRACTION_BITS 8 // The floor energy is 1.0, a sample is below 2^42 at the ceiling
+#define SOUND_LEVEL_LOG2_10_Q24 55733      // log2(10) / 1000 in Q24, converts 0.01 dB to a power of two
+#define SOUND_LEVEL_LOG2_TO_CENTI_DB 30103 // 10 * log10(2) * 10000, converts a power of two to 0.0001 dB
+
+TSoundLevel::TSoundLevel(): Max(0), Min(0), Energy(0), Count(0), Last({0, 0, 0, 0})
+{}
+
+void TSoundLevel::Add(int32_t level)
+{
+    if (Count == 0 || level > Max) {
+        Max = level;
+    }
+    if (Count == 0 || level < Min) {
+        Min = level;
+    }
+    if (level < SOUND_LEVEL_FLOOR) {
+        level = SOUND_LEVEL_FLOOR;
+    }
+    if (level > SOUND_LEVEL_CEILING) {
+        level = SOUND_LEVEL_CEILING;
+    }
+    // 10 ^ (L / 10) = 2 ^ (L * log2(10) / 10), the integer part of the power shifts the mantissa
+    int32_t power = ((level - SOUND_LEVEL_FLOOR) * SOUND_LEVEL_LOG2_10_Q24) >> 8;
+    uint64_t mantissa = WbMswFixedExp2(power & 0xFFFF);
+    Energy += (mantissa << (power >> 16)) >> (16 - SOUND_LEVEL_ENERGY_FRACTION_BITS);
+    Count++;
+}
+
+void TSoundLevel::Finish()
+{
+    Last.Max = Max;
+    Last.Min = Min;
+    Last.Count = Count;
+    Last.Leq = 0;
+    if (Count) {
+        uint64_t mean = Energy / Count;
+        int32_t shift = 0;
+        while ((mean >> shift) > UINT32_MAX) {
+            shift++;
+        }
+        int32_t power = WbMswFixedLog2((uint32_t)(mean >> shift)) +
+                        ((shift - SOUND_LEVEL_ENERGY_FRACTION_BITS) << 16);
+        Last.Leq = SOUND_LEVEL_FLOOR + (int32_t)((int64_t)power * SOUND_LEVEL_LOG2_TO_CENTI_DB / 100 >> 16);
+    }
+    Energy = 0;
+    Count = 0;
+}
+
+const TSoundLevel::Result& TSoundLevel::GetLast() const
+{
+    return Last;
+}
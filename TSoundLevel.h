@@ -0,0 +1,38 @@
+#ifndef T_SOUND_LEVEL_H
+#define T_SOUND_LEVEL_H
+
+#include <stdint.h>
+
+#define SOUND_LEVEL_FLOOR 3000    // 30 dB, the energy of quieter samples is taken at this level
+#define SOUND_LEVEL_CEILING 13000 // 130 dB, keeps the energy sum within 64 bits
+
+// Equivalent continuous sound level (Leq) with the maximum and minimum of the levels within a time window.
+// Levels in 0.01 dB are averaged in the energy domain: Leq = 10 * log10(mean(10 ^ (L / 10))),
+// the conversions are fixed point (see WbMswFixedPoint.h), so a sample costs a few integer operations.
+// Windows are tumbling: Finish() closes the current window and starts the next one
+class TSoundLevel
+{
+public:
+    struct Result
+    {
+        int32_t Leq;
+        int32_t Max;
+        int32_t Min;
+        uint32_t Count; // 0 - no samples in the window
+    };
+
+    TSoundLevel();
+    void Add(int32_t level);
+    void Finish();
+    // The last closed window
+    const TSoundLevel::Result& GetLast() const;
+
+private:
+    int32_t Max;
+    int32_t Min;
+    uint64_t Energy; // Sum of the sample energies relative to SOUND_LEVEL_FLOOR, fixed point
+    uint32_t Count;
+    TSoundLevel::Result Last;
+};
+
+#endif // T_SOUND_LEVEL_H
@@ -0,0 +1,51 @@
+#ifndef T_TOKEN_BUCKET_H
+#define T_TOKEN_BUCKET_H
+
+#include <stdint.h>
+
+// Token bucket rate limiter. Tokens are kept in 1/60000 units, so a rate per minute
+// is refilled exactly with a millisecond clock
+class TTokenBucket
+{
+public:
+    TTokenBucket(): Rate(0), Capacity(0), Tokens(0), LastTime(0)
+    {}
+
+    // rate - tokens per minute, 0 - unlimited; burst - tokens available at once
+    void SetRate(uint32_t rate, uint32_t burst, uint32_t currentTime)
+    {
+        Rate = rate;
+        Capacity = (uint64_t)burst * TOKEN_UNITS;
+        Tokens = Capacity;
+        LastTime = currentTime;
+    }
+
+    bool Check(uint32_t cost, uint32_t currentTime)
+    {
+        if (Rate == 0) {
+            return true;
+        }
+        Tokens += (uint64_t)(currentTime - LastTime) * Rate;
+        LastTime = currentTime;
+        if (Tokens > Capacity) {
+            Tokens = Capacity;
+        }
+        return Tokens >= (uint64_t)cost * TOKEN_UNITS;
+    }
+
+    // Must be called after a successful Check(), unless the consumer may overdraw the bucket
+    void Take(uint32_t cost)
+    {
+        uint64_t units = (uint64_t)cost * TOKEN_UNITS;
+        Tokens = Tokens > units ? Tokens - units : 0;
+    }
+
+private:
+    static const uint32_t TOKEN_UNITS = 60000; // ms per minute
+    uint32_t Rate;
+    uint64_t Capacity;
+    uint64_t Tokens;
+    uint32_t LastTime;
+};
+
+#endif // T_TOKEN_BUCKET_H
@@ -12,14 +12,12 @@
 #define WBMSW_REG_VOC 0x000B
 #define WBMSW_REG_NOISE 0x0003
 #define WBMSW_REG_MOTION 0x011B
+#define WBMSW_REG_MOTION_MAX 0x0118 // Maximum since the previous read of the register
 #define WBMSW_REG_FW_MODE 0x0081
 #define WBMSW_REG_FW_INFO 0x1000
 #define WBMSW_REG_FW_DATA 0x2000
 #define WBMSW_REG_FW_VERSION 0x00FA
 
-#define WBMSW_FIRMWARE_INFO_SIZE 32
-#define WBMSW_FIRMWARE_DATA_SIZE 136
-
 #define WBMSW_REG_TEMPERATURE_AVAIL 0x0170
 #define WBMSW_REG_HUMIDITY_AVAIL 0x0171
 #define WBMSW_REG_LUMINANCE_AVAIL 0x0172
@@ -27,6 +25,7 @@
 #define WBMSW_REG_VOC_AVAIL 0x0173
 #define WBMSW_REG_NOISE_AVAIL 0x0176
 #define WBMSW_REG_MOTION_AVAIL 0x0175
+#define WBMSW_REG_AVAIL_FIRST WBMSW_REG_TEMPERATURE_AVAIL
 
 #define WBMSW_COIL_BUZZER 0x0000
 
@@ -41,7 +40,9 @@
 TWBMSWSensor::TWBMSWSensor(HardwareSerial* hardwareSerial, uint16_t timeoutMs)
     : ModBusRtuClass(hardwareSerial, timeoutMs),
       LedStatusRed(LedStatus::LED_STATUS_UNKNOWN),
-      LedStatusGreen(LedStatus::LED_STATUS_UNKNOWN)
+      LedStatusGreen(LedStatus::LED_STATUS_UNKNOWN),
+      MotionMaxAvailability(TWBMSWSensor::Availability::UNKNOWN),
+      AvailabilityBlockRead(false)
 {}
 
 /* Public Methods */
@@ -60,6 +61,13 @@ void TWBMSWSensor::ClosePort(void)
 void TWBMSWSensor::SetModbusAddress(uint8_t address)
 {
     this->Address = address;
+    // It may be another sensor or another firmware
+    MotionMaxAvailability = TWBMSWSensor::Availability::UNKNOWN;
+}
+
+uint8_t TWBMSWSensor::GetModbusAddress(void) const
+{
+    return this->Address;
 }
 
 bool TWBMSWSensor::GetFwVersion(uint16_t& version)
@@ -181,18 +189,44 @@ bool TWBMSWSensor::GetNoiseLevel(int64_t& noiseLevel)
 bool TWBMSWSensor::GetMotion(int64_t& motion)
 {
     uint16_t motionTmp;
-    if (readInputRegisters(Address, WBMSW_REG_MOTION, 1, &motionTmp)) { // 0x0118 - max
+    if (readInputRegisters(Address, WBMSW_REG_MOTION, 1, &motionTmp)) {
+        motion = motionTmp;
+        return true;
+    }
+    return false;
+}
+
+// Returns false if the register can't be read. If the current value can be read meanwhile,
+// the sensor firmware has no such register, so it is marked unavailable and never read again
+bool TWBMSWSensor::GetMotionMax(int64_t& motion)
+{
+    if (MotionMaxAvailability == TWBMSWSensor::Availability::UNAVAILABLE) {
+        return false;
+    }
+    uint16_t motionTmp;
+    if (readInputRegisters(Address, WBMSW_REG_MOTION_MAX, 1, &motionTmp)) {
+        MotionMaxAvailability = TWBMSWSensor::Availability::AVAILABLE;
         motion = motionTmp;
         return true;
     }
+    if (MotionMaxAvailability == TWBMSWSensor::Availability::UNKNOWN && GetMotion(motion)) {
+        MotionMaxAvailability = TWBMSWSensor::Availability::UNAVAILABLE;
+    }
     return false;
 }
 
+TWBMSWSensor::Availability TWBMSWSensor::GetMotionMaxAvailability(void) const
+{
+    return MotionMaxAvailability;
+}
+
+// Asks the firmware to reboot into the bootloader
 bool TWBMSWSensor::SetFwMode(void)
 {
     return writeSingleRegisters(Address, WBMSW_REG_FW_MODE, 1);
 }
 
+// Starts the bootloader flashing session. Fails while the bootloader is not ready yet
 bool TWBMSWSensor::FwWriteInfo(uint16_t* info)
 {
     uint16_t infoData[WBMSW_FIRMWARE_INFO_SIZE / sizeof(uint16_t)];
@@ -214,45 +248,6 @@ bool TWBMSWSensor::FwWriteData(uint16_t* data)
                                   firmwareData);
 }
 
-bool TWBMSWSensor::FwUpdate(uint16_t* buffer, size_t length, uint16_t timeoutMs)
-{
-    // len in words, WBMSW_FIRMWARE_INFO_SIZE in bytes
-    if (length < WBMSW_FIRMWARE_INFO_SIZE / sizeof(uint16_t)) {
-        return false;
-    }
-    DEBUG("FW size: ");
-    DEBUG(length * 2);
-    DEBUG("\n");
-
-    if (!this->SetFwMode()) {
-        DEBUG("ERROR Supposed to be alive, but found in bootloader");
-        return false;
-    }
-
-    delay(timeoutMs);
-    uint16_t* data = buffer;
-
-    if (!this->FwWriteInfo(data)) {
-        DEBUG("ERROR Unsuccesful info block write");
-        return false;
-    }
-    DEBUG("Write info\n");
-    data += WBMSW_FIRMWARE_INFO_SIZE / sizeof(uint16_t);
-    length -= WBMSW_FIRMWARE_INFO_SIZE / sizeof(uint16_t);
-
-    DEBUG("Write data\n");
-    while (length) {
-        if (!FwWriteData(data)) {
-            return false;
-        }
-        data += WBMSW_FIRMWARE_DATA_SIZE / sizeof(uint16_t);
-        length -= WBMSW_FIRMWARE_DATA_SIZE / sizeof(uint16_t);
-    }
-
-    DEBUG("Write finish\n");
-    return true;
-}
-
 TWBMSWSensor::Availability TWBMSWSensor::ConvertAvailability(uint16_t availability) const
 {
     switch (availability) {
@@ -265,8 +260,25 @@ TWBMSWSensor::Availability TWBMSWSensor::ConvertAvailability(uint16_t availabili
     }
 }
 
+// Reads all availability registers in one transaction. Until ReleaseAvailabilityBlock() is called
+// the Get*Availability() functions return the values read instead of polling the sensor
+bool TWBMSWSensor::ReadAvailabilityBlock(void)
+{
+    AvailabilityBlockRead = readInputRegisters(Address, WBMSW_REG_AVAIL_FIRST, WBMSW_AVAIL_COUNT, AvailabilityBlock);
+    return AvailabilityBlockRead;
+}
+
+void TWBMSWSensor::ReleaseAvailabilityBlock(void)
+{
+    AvailabilityBlockRead = false;
+}
+
 bool TWBMSWSensor::ReadAvailabilityRegister(TWBMSWSensor::Availability& availability, uint16_t registerAddress)
 {
+    if (AvailabilityBlockRead) {
+        availability = ConvertAvailability(AvailabilityBlock[registerAddress - WBMSW_REG_AVAIL_FIRST]);
+        return true;
+    }
     uint16_t availabilityFlag;
     if (readInputRegisters(Address, registerAddress, 1, &availabilityFlag)) {
         availability = ConvertAvailability(availabilityFlag);
@@ -303,6 +315,32 @@ bool TWBMSWSensor::GetMotionAvailability(TWBMSWSensor::Availability& availabilit
 {
     return ReadAvailabilityRegister(availability, WBMSW_REG_MOTION_AVAIL);
 }
+
+// Values computed from two sensors are available when both sensors are
+bool TWBMSWSensor::ReadAvailabilityRegisters(TWBMSWSensor::Availability& availability,
+                                             uint16_t firstRegisterAddress,
+                                             uint16_t secondRegisterAddress)
+{
+    TWBMSWSensor::Availability second;
+    if (!ReadAvailabilityRegister(availability, firstRegisterAddress) ||
+        !ReadAvailabilityRegister(second, secondRegisterAddress))
+    {
+        return false;
+    }
+    if (availability == TWBMSWSensor::Availability::AVAILABLE || second == TWBMSWSensor::Availability::UNAVAILABLE) {
+        availability = second;
+    }
+    return true;
+}
+bool TWBMSWSensor::GetClimateAvailability(TWBMSWSensor::Availability& availability)
+{
+    return ReadAvailabilityRegisters(availability, WBMSW_REG_TEMPERATURE_AVAIL, WBMSW_REG_HUMIDITY_AVAIL);
+}
+bool TWBMSWSensor::GetAirQualityAvailability(TWBMSWSensor::Availability& availability)
+{
+    return ReadAvailabilityRegisters(availability, WBMSW_REG_CO2_AVAIL, WBMSW_REG_VOC_AVAIL);
+}
+
 bool TWBMSWSensor::BuzzerAvailable(TWBMSWSensor::Availability& availability)
 {
     availability = TWBMSWSensor::Availability::AVAILABLE;
@@ -3,6 +3,10 @@
 
 #include "ModBusRtu.h"
 
+#define WBMSW_FIRMWARE_INFO_SIZE 32  // bytes
+#define WBMSW_FIRMWARE_DATA_SIZE 136 // bytes
+#define WBMSW_AVAIL_COUNT 7          // Availability registers of all sensors
+
 class TWBMSWSensor: private ModBusRtuClass
 {
 public:
@@ -27,6 +31,7 @@ public:
     bool OpenPort(size_t speed, uint32_t config, uint8_t rx, uint8_t tx);
     void ClosePort(void);
     void SetModbusAddress(uint8_t address);
+    uint8_t GetModbusAddress(void) const;
     bool GetFwVersion(uint16_t& version);
     bool GetTemperature(int64_t& temperature);
     bool GetHumidity(int64_t& humidity);
@@ -38,7 +43,8 @@ public:
     bool GetVoc(int64_t& voc);
     bool GetNoiseLevel(int64_t& noiseLevel);
     bool GetMotion(int64_t& motion);
-    bool FwUpdate(uint16_t* buffer, size_t length, uint16_t timeoutMs = 2000);
+    bool GetMotionMax(int64_t& motion);
+    TWBMSWSensor::Availability GetMotionMaxAvailability(void) const;
 
     bool GetTemperatureAvailability(TWBMSWSensor::Availability& availability);
     bool GetHumidityAvailability(TWBMSWSensor::Availability& availability);
@@ -47,6 +53,10 @@ public:
     bool GetVocAvailability(TWBMSWSensor::Availability& availability);
     bool GetNoiseLevelAvailability(TWBMSWSensor::Availability& availability);
     bool GetMotionAvailability(TWBMSWSensor::Availability& availability);
+    bool GetClimateAvailability(TWBMSWSensor::Availability& availability);
+    bool GetAirQualityAvailability(TWBMSWSensor::Availability& availability);
+    bool ReadAvailabilityBlock(void);
+    void ReleaseAvailabilityBlock(void);
 
     bool BuzzerAvailable(TWBMSWSensor::Availability& availability);
     bool BuzzerStart(void);
@@ -61,14 +71,21 @@ public:
     LedStatus GetLedRedStatus(void);
     LedStatus GetLedGreenStatus(void);
 
-private:
     bool SetFwMode(void);
     bool FwWriteInfo(uint16_t* info);
-    bool FwWriteData(uint16_t* info);
+    bool FwWriteData(uint16_t* data);
+
+private:
     TWBMSWSensor::Availability ConvertAvailability(uint16_t availability) const;
     bool ReadAvailabilityRegister(TWBMSWSensor::Availability& availability, uint16_t registerAddress);
+    bool ReadAvailabilityRegisters(TWBMSWSensor::Availability& availability,
+                                   uint16_t firstRegisterAddress,
+                                   uint16_t secondRegisterAddress);
     uint8_t Address;
     LedStatus LedStatusRed;
     LedStatus LedStatusGreen;
+    TWBMSWSensor::Availability MotionMaxAvailability; // The register appeared in later sensor firmwares
+    uint16_t AvailabilityBlock[WBMSW_AVAIL_COUNT];
+    bool AvailabilityBlockRead;
 };
 #endif // WB_MSW_SENSOR_H
\ No newline at end of file
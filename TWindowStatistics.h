@@ -0,0 +1,66 @@
+#ifndef T_WINDOW_STATISTICS_H
+#define T_WINDOW_STATISTICS_H
+
+#include <stdint.h>
+
+// Minimum, maximum and mean of the values within a time window, updated in O(1) per value.
+// Windows are tumbling: Finish() closes the current window and starts the next one
+class TWindowStatistics
+{
+public:
+    struct Result
+    {
+        int32_t Min;
+        int32_t Max;
+        int32_t Mean;
+        uint32_t Count; // 0 - no values in the window
+    };
+
+    TWindowStatistics(): Min(0), Max(0), Sum(0), Count(0), Last({0, 0, 0, 0})
+    {}
+
+    void Add(int32_t value)
+    {
+        if (Count == 0 || value < Min) {
+            Min = value;
+        }
+        if (Count == 0 || value > Max) {
+            Max = value;
+        }
+        Sum += value;
+        Count++;
+    }
+
+    void Finish()
+    {
+        Last.Min = Min;
+        Last.Max = Max;
+        Last.Mean = Count ? (int32_t)(Sum / (int64_t)Count) : 0;
+        Last.Count = Count;
+        Sum = 0;
+        Count = 0;
+    }
+
+    // Forgets the current and the last window, e.g. after the window length has changed
+    void Reset()
+    {
+        Sum = 0;
+        Count = 0;
+        Last = {0, 0, 0, 0};
+    }
+
+    // The last closed window
+    const TWindowStatistics::Result& GetLast() const
+    {
+        return Last;
+    }
+
+private:
+    int32_t Min;
+    int32_t Max;
+    int64_t Sum;
+    uint32_t Count;
+    TWindowStatistics::Result Last;
+};
+
+#endif // T_WINDOW_STATISTICS_H
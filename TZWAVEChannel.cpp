@@ -1,13 +1,23 @@
 #include "TZWAVEChannel.h"
 #include "Arduino.h"
+#include "WbMsw.h"
 
 TZWAVEChannel::TZWAVEChannel()
 {
     this->ReportedValue = 0;
+    this->ReportTime = 0;
+    this->SlopeValue = 0;
+    this->SlopeTime = 0;
+    this->SlopeInitialized = false;
+    this->SlopePreviousValue = 0;
+    this->SlopePreviousTime = 0;
+    this->SlopeReady = false;
+    this->Policy = {};
     this->Triggered = false;
     this->ValueInitializationState = TZWAVEChannel::State::UNINITIALIZED;
     this->Availability = TWBMSWSensor::Availability::UNKNOWN;
     this->Enabled = false;
+    this->Endpoint = false;
 }
 
 void TZWAVEChannel::ChannelInitialize(String name,
@@ -51,14 +61,25 @@ String TZWAVEChannel::GetName() const
     return Name;
 }
 
-void TZWAVEChannel::SetValue(int64_t value)
+void TZWAVEChannel::SetValue(int32_t value)
 {
-    Value = value;
+    TZWAVEChannel::Sample sample = {value, millis()};
+    Value.Write(sample);
 }
 
-void* TZWAVEChannel::GetValuePointer()
+int32_t TZWAVEChannel::GetValue() const
 {
-    return &Value;
+    TZWAVEChannel::Sample sample;
+    Value.Read(sample);
+    return sample.Value;
+}
+
+int32_t TZWAVEChannel::GetValue(uint32_t& time) const
+{
+    TZWAVEChannel::Sample sample;
+    Value.Read(sample);
+    time = sample.Time;
+    return sample.Value;
 }
 
 bool TZWAVEChannel::ReadValueFromSensor(int64_t& value)
@@ -81,6 +102,21 @@ void TZWAVEChannel::Enable()
     Enabled = true;
 }
 
+void TZWAVEChannel::Disable()
+{
+    Enabled = false;
+}
+
+bool TZWAVEChannel::HasEndpoint() const
+{
+    return Endpoint;
+}
+
+void TZWAVEChannel::SetEndpoint(bool endpoint)
+{
+    Endpoint = endpoint;
+}
+
 TZWAVEChannel::Type TZWAVEChannel::GetType() const
 {
     return ChannelType;
@@ -109,9 +145,52 @@ int64_t TZWAVEChannel::GetReportedValue() const
 void TZWAVEChannel::SetReportedValue(int64_t reportedValue)
 {
     ReportedValue = reportedValue;
+    ReportTime = millis();
     ValueInitializationState = TZWAVEChannel::State::INITIALIZED;
 }
 
+uint32_t TZWAVEChannel::GetReportTime() const
+{
+    return ReportTime;
+}
+
+// Returns the value change per minute over the last WB_MSW_SLOPE_WINDOW_MS ... 2 * WB_MSW_SLOPE_WINDOW_MS.
+// The slope is 0 until the first window passes, so a single reading isn't taken as a trend
+int32_t TZWAVEChannel::UpdateSlope(int32_t value)
+{
+    uint32_t currentTime = millis();
+    if (!SlopeInitialized) {
+        SlopeValue = value;
+        SlopeTime = currentTime;
+        SlopeInitialized = true;
+        return 0;
+    }
+    // The reference is renewed once per window and the previous one is kept, so the rate of change is always
+    // measured over at least the window, not over the time since the last renewal
+    if (currentTime - SlopeTime >= WB_MSW_SLOPE_WINDOW_MS) {
+        SlopePreviousValue = SlopeValue;
+        SlopePreviousTime = SlopeTime;
+        SlopeReady = true;
+        SlopeValue = value;
+        SlopeTime = currentTime;
+    }
+    if (!SlopeReady) {
+        return 0;
+    }
+    uint32_t interval = currentTime - SlopePreviousTime;
+    return (int32_t)(((int64_t)value - SlopePreviousValue) * 60000 / interval);
+}
+
+const TZWAVEChannel::ReportPolicy& TZWAVEChannel::GetReportPolicy() const
+{
+    return Policy;
+}
+
+void TZWAVEChannel::SetReportPolicy(const TZWAVEChannel::ReportPolicy& policy)
+{
+    Policy = policy;
+}
+
 bool TZWAVEChannel::GetTriggered() const
 {
     return Triggered;
@@ -147,6 +226,31 @@ TZWAVEChannel::State TZWAVEChannel::GetState() const
     return ValueInitializationState;
 }
 
+// The next value is reported without conditions
+void TZWAVEChannel::ResetState()
+{
+    ValueInitializationState = TZWAVEChannel::State::UNINITIALIZED;
+    Triggered = false;
+    SlopeInitialized = false;
+    SlopeReady = false;
+    Filter.Reset();
+}
+
+void TZWAVEChannel::SetFilter(uint8_t medianSize, uint32_t timeConstantMs)
+{
+    Filter.Configure(medianSize, timeConstantMs);
+}
+
+int32_t TZWAVEChannel::FilterValue(int32_t value)
+{
+    return Filter.Process(value, millis());
+}
+
+TWindowStatistics& TZWAVEChannel::GetStatistics()
+{
+    return Statistics;
+}
+
 TWBMSWSensor::Availability TZWAVEChannel::GetAvailability()
 {
     return Availability;
@@ -1,4 +1,7 @@
 #include "Arduino.h"
+#include "TSeqLock.h"
+#include "TSignalFilter.h"
+#include "TWindowStatistics.h"
 #include "TWBMSWSensor.h"
 
 class TZWAVEChannel
@@ -21,8 +24,37 @@ public:
         MOTION,
         INTRUSION,
         BUZZER,
+        // Computed from the values of other channels
+        DEW_POINT,
+        ABSOLUTE_HUMIDITY,
+        AIR_QUALITY,
+    };
+    static const int CHANNEL_TYPES_COUNT = 12;
+
+    // Rule deciding when an analog value is reported
+    enum class ReportMode
+    {
+        ABSOLUTE, // The change since the last report exceeds the report threshold
+        RELATIVE, // The change exceeds the percentage of the last reported value
+        SLOPE     // As ABSOLUTE, or the value changes faster than the slope threshold per minute
+    };
+
+    // Reporting rules resolved from the configuration parameters and scaled to the channel value units
+    struct ReportPolicy
+    {
+        int32_t ReportThresHold; // 0 - reports disabled
+        int32_t LevelOn;         // Basic Set level + hysteresis
+        int32_t LevelOff;        // Basic Set level - hysteresis
+        uint8_t OnCommand;
+        uint8_t OffCommand;
+        bool SendOnCommand;
+        bool SendOffCommand;
+        uint32_t OffDelayMs;  // Motion and intrusion channels only
+        uint32_t MaxValueAgeMs; // Older values are read again on controller requests, 0 - never
+        uint32_t MaxReportIntervalMs; // The value is reported again after this time without reports, 0 - never
+        TZWAVEChannel::ReportMode Mode;
+        int32_t ModeThreshold; // Percent for RELATIVE, change per minute for SLOPE
     };
-    static const int CHANNEL_TYPES_COUNT = 9;
 
     TZWAVEChannel();
     void ChannelInitialize(String name,
@@ -42,12 +74,19 @@ public:
     void SetChannelNumbers(uint8_t channelDeviceNumber, uint8_t channelServerNumber, uint8_t groupIndex);
 
     String GetName() const;
-    void SetValue(int64_t value);
-    void* GetValuePointer();
+    void SetValue(int32_t value);
+    int32_t GetValue() const;
+    int32_t GetValue(uint32_t& time) const;
     bool ReadValueFromSensor(int64_t& value);
+    void SetFilter(uint8_t medianSize, uint32_t timeConstantMs);
+    int32_t FilterValue(int32_t value);
+    TWindowStatistics& GetStatistics();
     int32_t GetErrorValue() const;
     bool GetEnabled() const;
     void Enable();
+    void Disable();
+    bool HasEndpoint() const;
+    void SetEndpoint(bool endpoint);
 
     TZWAVEChannel::Type GetType() const;
     uint8_t GetGroupIndex() const;
@@ -85,6 +124,11 @@ public:
 
     int64_t GetReportedValue() const;
     void SetReportedValue(int64_t reportedValue);
+    uint32_t GetReportTime() const;
+    int32_t UpdateSlope(int32_t value);
+
+    const TZWAVEChannel::ReportPolicy& GetReportPolicy() const;
+    void SetReportPolicy(const TZWAVEChannel::ReportPolicy& policy);
 
     bool GetTriggered() const;
     void SetTriggered(bool triggered);
@@ -94,22 +138,41 @@ public:
     bool SetPowerOn();
 
     TZWAVEChannel::State GetState() const;
+    void ResetState();
     TWBMSWSensor::Availability GetAvailability();
     bool UpdateAvailability();
 
 private:
     String Name;
-    int64_t Value;
+    struct Sample
+    {
+        int32_t Value; // All sensor values fit 32 bits once validated
+        uint32_t Time; // millis() of the update
+    };
+    // Written by the poll loop, read by controller GET handlers
+    TSeqLock<TZWAVEChannel::Sample> Value;
     int32_t ErrorValue;
+    TSignalFilter Filter; // Applied to the values read from the sensor before they are published
+    TWindowStatistics Statistics;
     TZWAVEChannel::State ValueInitializationState;
     TWBMSWSensor::Availability Availability;
-    bool Enabled;
+    bool Enabled;  // The sensor is available and polled
+    bool Endpoint; // The channel has a Z-Wave endpoint, even if its sensor is not available
     TZWAVEChannel::Type ChannelType;
     uint8_t DeviceChannelNumber;
     uint8_t ServerChannelNumber;
     uint8_t GroupIndex;
 
     int64_t ReportedValue; // A value sent to the controller
+    uint32_t ReportTime;   // millis() of the last report
+    int32_t SlopeValue;    // Reference sample of the current slope window
+    uint32_t SlopeTime;
+    bool SlopeInitialized;
+    // Reference sample of the previous window, the rate of change is measured from it
+    int32_t SlopePreviousValue;
+    uint32_t SlopePreviousTime;
+    bool SlopeReady;
+    TZWAVEChannel::ReportPolicy Policy;
     bool Triggered;        // Threshold exceeding trigger flag
     bool Autocalibration;  // For CO2 channel type
 
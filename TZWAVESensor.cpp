@@ -1,7 +1,10 @@
 #include "TZWAVESensor.h"
 #include "Arduino.h"
+#include "CrcClass.h"
 #include "DebugOutput.h"
 #include "WbMsw.h"
+#include "WbMswDerived.h"
+#include "WbMswRetention.h"
 #include <string.h>
 
 #define WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MULTIPLIER 1
@@ -11,193 +14,560 @@
 #define WB_MSW_CONFIG_PARAMETER_VOC_MULTIPLIER 1
 #define WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MULTIPLIER 100
 #define WB_MSW_CONFIG_PARAMETER_MOTION_MULTIPLIER 1
+#define WB_MSW_CONFIG_PARAMETER_DEW_POINT_MULTIPLIER 1
+#define WB_MSW_CONFIG_PARAMETER_ABSOLUTE_HUMIDITY_MULTIPLIER 1
+#define WB_MSW_CONFIG_PARAMETER_AIR_QUALITY_MULTIPLIER 1
 #define WB_MSW_CONFIG_PARAMETER_MOTION_ON 300
 #define WB_MSW_CONFIG_PARAMETER_MOTION_OFF 250
 #define WB_MSW_CONFIG_PARAMETER_CO2_AUTO_VALUE true
 
+// TZWAVESensor::ParametersState bits
+#define WB_MSW_PARAMETERS_PUBLISHED 0x01
+#define WB_MSW_PARAMETERS_FLASH_RESET 0x02 // Counter increment
+
+// Parameter the controller can only read, its value is updated by the device
+#define WB_MSW_CONFIG_PARAMETER_INFO_READ_ONLY(NAME, INFO)                                                             \
+    {NAME,                                                                                                             \
+     INFO,                                                                                                             \
+     INT32_MIN,                                                                                                        \
+     INT32_MAX,                                                                                                        \
+     0,                                                                                                                \
+     ZUNO_CFG_PARAMETER_SIZE_32BIT,                                                                                    \
+     ZUNO_CFG_PARAMETER_FORMAT_SIGNED,                                                                                 \
+     true,                                                                                                             \
+     false,                                                                                                            \
+     false}
+
+// Parameters repeated for each analog channel, they differ only in the channel name
+#define WB_MSW_CONFIG_PARAMETER_INFO_MAX_VALUE_AGE(CHANNEL)                                                            \
+    ZUNO_CONFIG_PARAMETER_INFO(CHANNEL " Maximum Value Age",                                                           \
+                               "0 - Disabled. Get is answered at once with the last polled value. If the value is "    \
+                               "older, the sensor is read out of turn and a changed value is reported after the "      \
+                               "answer. Value in seconds.",                                                            \
+                               0,                                                                                      \
+                               3600,                                                                                   \
+                               0)
+
+#define WB_MSW_CONFIG_PARAMETER_INFO_REPORTS_RATE_LIMIT(CHANNEL)                                                       \
+    ZUNO_CONFIG_PARAMETER_INFO(CHANNEL " Reports Rate Limit",                                                          \
+                               "0 - Unlimited. Reports per minute. Reports over the limit are delayed and send "       \
+                               "the latest value.",                                                                    \
+                               0,                                                                                      \
+                               600,                                                                                    \
+                               0)
+
+#define WB_MSW_CONFIG_PARAMETER_INFO_MAX_REPORT_INTERVAL(CHANNEL)                                                      \
+    ZUNO_CONFIG_PARAMETER_INFO(CHANNEL " Maximum Report Interval",                                                     \
+                               "0 - Report on changes only. Report the value again if it hasn't been reported "        \
+                               "for this time. Value in seconds.",                                                     \
+                               0,                                                                                      \
+                               86400,                                                                                  \
+                               0)
+
+#define WB_MSW_CONFIG_PARAMETER_INFO_MEDIAN_FILTER_SIZE(CHANNEL)                                                       \
+    ZUNO_CONFIG_PARAMETER_INFO(CHANNEL " Median Filter Size",                                                          \
+                               "1 - No filter. Number of the last readings the median is taken from, an odd "          \
+                               "number rejects single spikes.",                                                        \
+                               1,                                                                                      \
+                               5,                                                                                      \
+                               1)
+
+#define WB_MSW_CONFIG_PARAMETER_INFO_SMOOTHING_TIME(CHANNEL)                                                           \
+    ZUNO_CONFIG_PARAMETER_INFO(CHANNEL " Smoothing Time",                                                              \
+                               "0 - No smoothing. Time constant of the moving average. Value in seconds.",             \
+                               0,                                                                                      \
+                               3600,                                                                                   \
+                               0)
+
+#define WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE(CHANNEL)                                                              \
+    ZUNO_CONFIG_PARAMETER_INFO(CHANNEL " Report Mode",                                                                 \
+                               "0 - Report the change over Report Threshold. 1 - Report the change over Report Mode "  \
+                               "Threshold percent of the last report. 2 - As 0, or report the change faster than "     \
+                               "Report Mode Threshold per minute.",                                                    \
+                               0,                                                                                      \
+                               2,                                                                                      \
+                               0)
+
+#define WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE_THRESHOLD(CHANNEL, UNIT)                                              \
+    ZUNO_CONFIG_PARAMETER_INFO(CHANNEL " Report Mode Threshold",                                                       \
+                               "Percent for Report Mode 1. Change per minute for Report Mode 2, value in " UNIT ".",   \
+                               1,                                                                                      \
+                               100000,                                                                                 \
+                               10)
+
+// Available device parameters description, indexed by (parameter number - WB_MSW_CONFIG_PARAMETER_FIRST)
+// Channels in the device are created dynamically, so parameters are described in "dynamic" style.
+// The table is constexpr, so descriptions stay in flash, and every parameter carries the type of the channel it
+// configures, so zunoCFGParameter() requests are answered with a single lookup.
+// Device wide parameters don't depend on channels and are always available
+typedef struct
+{
+    TZWAVEChannel::Type ChannelType; // DeviceWideParameterType for device wide parameters
+    ZunoCFGParameter_t Description;
+} TZWAVEParameter;
+
+static constexpr TZWAVEChannel::Type DeviceWideParameterType =
+    static_cast<TZWAVEChannel::Type>(TZWAVEChannel::CHANNEL_TYPES_COUNT);
+
+static constexpr TZWAVEParameter Parameters[] = {
+    // Motion sensor settings
+    {TZWAVEChannel::Type::MOTION,
+     ZUNO_CONFIG_PARAMETER_INFO("Motion delay to send OFF command", "Value in seconds.", 0, 100000, 60)},
+    {TZWAVEChannel::Type::MOTION,
+     ZUNO_CONFIG_PARAMETER_INFO("Motion ON command", "Send Basic Set command.", 0, 255, 255)},
+    {TZWAVEChannel::Type::MOTION,
+     ZUNO_CONFIG_PARAMETER_INFO("Motion OFF command", "Send Basic Set command.", 0, 255, 0)},
+    {TZWAVEChannel::Type::MOTION,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "Motion ON/OFF commands rules",
+         "1 - Send ON if the motion is detected. Send OFF if the motion is idle. 2 - Send ON if the motion is "
+         "detected. Do not send OFF. 3 - Do not send ON. Send OFF if the motion is idle.",
+         1,
+         3,
+         1)},
+
+    // Temperature channel settings
+    {TZWAVEChannel::Type::TEMPERATURE,
+     ZUNO_CONFIG_PARAMETER_INFO("Temperature Report Threshold",
+                                "0 - Reports disabled. Send Report if the temperature has changed after the last "
+                                "report. Value in 0.01C (100 = 1C).",
+                                0,
+                                4000,
+                                100)},
+    {TZWAVEChannel::Type::TEMPERATURE,
+     ZUNO_CONFIG_PARAMETER_INFO_SIGN("Temperature Level to send Basic Set",
+                                     "Send Basic Set if the temperature has crossed the level up or down + "
+                                     "hysteresis. Value in 0.01C (100 = 1C).",
+                                     -4000,
+                                     8000,
+                                     4000)},
+    {TZWAVEChannel::Type::TEMPERATURE,
+     ZUNO_CONFIG_PARAMETER_INFO("Temperature Hysteresis to send Basic Set",
+                                "Value in 0.01C (100 = 1C).",
+                                10,
+                                2000,
+                                50)},
+    {TZWAVEChannel::Type::TEMPERATURE,
+     ZUNO_CONFIG_PARAMETER_INFO("Temperature ON command", "Send Basic Set command.", 0, 255, 255)},
+    {TZWAVEChannel::Type::TEMPERATURE,
+     ZUNO_CONFIG_PARAMETER_INFO("Temperature OFF command", "Send Basic Set command.", 0, 255, 0)},
+    {TZWAVEChannel::Type::TEMPERATURE,
+     ZUNO_CONFIG_PARAMETER_INFO("Temperature ON/OFF commands rules",
+                                "1 - Send ON if the temperature is greater than Level. Send OFF if the temperature "
+                                "is less than Level. 2 - Send ON if the temperature is greater than Level. Do not "
+                                "send OFF. 3 - Do not send ON. Send OFF if the temperature is less than Level.",
+                                1,
+                                3,
+                                1)},
+
+    // Humidity sensor settings
+    {TZWAVEChannel::Type::HUMIDITY,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "Humidity Report Threshold",
+         "0 - Reports disabled. Send Report if the humidity has changed after the last report. Value in %.",
+         0,
+         90,
+         5)},
+    {TZWAVEChannel::Type::HUMIDITY,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "Humidity Level to send Basic Set",
+         "Send Basic Set if the humidity has crossed the level up or down + hysteresis. Value in %.",
+         5,
+         95,
+         60)},
+    {TZWAVEChannel::Type::HUMIDITY,
+     ZUNO_CONFIG_PARAMETER_INFO("Humidity Hysteresis to send Basic Set", "Value in %.", 1, 50, 2)},
+    {TZWAVEChannel::Type::HUMIDITY,
+     ZUNO_CONFIG_PARAMETER_INFO("Humidity ON command", "Send Basic Set command.", 0, 255, 255)},
+    {TZWAVEChannel::Type::HUMIDITY,
+     ZUNO_CONFIG_PARAMETER_INFO("Humidity OFF command", "Send Basic Set command.", 0, 255, 0)},
+    {TZWAVEChannel::Type::HUMIDITY,
+     ZUNO_CONFIG_PARAMETER_INFO("Humidity ON/OFF commands rules",
+                                "1 - Send ON if the humidity is greater than Level. Send OFF if the humidity is "
+                                "less than Level. 2 - Send ON if the humidity is greater than Level. Do not send "
+                                "OFF. 3 - Do not send ON. Send OFF if the humidity is less than Level.",
+                                1,
+                                3,
+                                1)},
+
+    // Lumen sensor settings
+    {TZWAVEChannel::Type::LUMEN,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "Luminance Report Threshold",
+         "0 - Reports disabled. Send Report if the luminance has changed after the last report. Value in lux.",
+         0,
+         100000,
+         100)},
+    {TZWAVEChannel::Type::LUMEN,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "Luminance Level to send Basic Set",
+         "Send Basic Set if the luminance has crossed the level up or down + hysteresis. Value in lux.",
+         0,
+         100000,
+         200)},
+    {TZWAVEChannel::Type::LUMEN,
+     ZUNO_CONFIG_PARAMETER_INFO("Luminance Hysteresis to send Basic Set", "Value in lux.", 1, 50000, 50)},
+    {TZWAVEChannel::Type::LUMEN,
+     ZUNO_CONFIG_PARAMETER_INFO("Luminance ON command", "Send Basic Set command.", 0, 255, 255)},
+    {TZWAVEChannel::Type::LUMEN,
+     ZUNO_CONFIG_PARAMETER_INFO("Luminance OFF command", "Send Basic Set command.", 0, 255, 0)},
+    {TZWAVEChannel::Type::LUMEN,
+     ZUNO_CONFIG_PARAMETER_INFO("Luminance ON/OFF commands rules",
+                                "1 - Send ON if the luminance is greater than Level. Send OFF if the luminance is "
+                                "less than Level. 2 - Send ON if the luminance is greater than Level. Do not send "
+                                "OFF. 3 - Do not send ON. Send OFF if the luminance is less than Level.",
+                                1,
+                                3,
+                                1)},
+
+    // CO2 sensor settings
+    {TZWAVEChannel::Type::CO2,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "CO2 Report Threshold",
+         "0 - Reports disabled. Send Report if the CO2 has changed after the last report. Value in ppm.",
+         0,
+         5000,
+         100)},
+    {TZWAVEChannel::Type::CO2,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "CO2 Level to send Basic Set",
+         "Send Basic Set if the CO2 has crossed the level up or down + hysteresis. Value in ppm.",
+         400,
+         5000,
+         1500)},
+    {TZWAVEChannel::Type::CO2,
+     ZUNO_CONFIG_PARAMETER_INFO("CO2 Hysteresis to send Basic Set", "Value in ppm.", 1, 2500, 50)},
+    {TZWAVEChannel::Type::CO2,
+     ZUNO_CONFIG_PARAMETER_INFO("CO2 ON command", "Send Basic Set command.", 0, 255, 255)},
+    {TZWAVEChannel::Type::CO2,
+     ZUNO_CONFIG_PARAMETER_INFO("CO2 OFF command", "Send Basic Set command.", 0, 255, 0)},
+    {TZWAVEChannel::Type::CO2,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "CO2 ON/OFF commands rules",
+         "1 - Send ON if the CO2 is greater than Level. Send OFF if the CO2 is less than Level. 2 - Send ON if the "
+         "CO2 is greater than Level. Do not send OFF. 3 - Do not send ON. Send OFF if the CO2 is less than Level.",
+         1,
+         3,
+         1)},
+
+    // VOC sensor settings
+    {TZWAVEChannel::Type::VOC,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "VOC Report Threshold",
+         "0 - Reports disabled. Send Report if the VOC has changed after the last report. Value in ppb.",
+         0,
+         60000,
+         200)},
+    {TZWAVEChannel::Type::VOC,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "VOC Level to send Basic Set",
+         "Send Basic Set if the VOC has crossed the level up or down + hysteresis. Value in ppb.",
+         0,
+         60000,
+         660)},
+    {TZWAVEChannel::Type::VOC,
+     ZUNO_CONFIG_PARAMETER_INFO("VOC Hysteresis to send Basic Set", "Value in ppb.", 1, 30000, 200)},
+    {TZWAVEChannel::Type::VOC,
+     ZUNO_CONFIG_PARAMETER_INFO("VOC ON command", "Send Basic Set command.", 0, 255, 255)},
+    {TZWAVEChannel::Type::VOC,
+     ZUNO_CONFIG_PARAMETER_INFO("VOC OFF command", "Send Basic Set command.", 0, 255, 0)},
+    {TZWAVEChannel::Type::VOC,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "VOC ON/OFF commands rules",
+         "1 - Send ON if the VOC is greater than Level. Send OFF if the VOC is less than Level. 2 - Send ON if the "
+         "VOC is greater than Level. Do not send OFF. 3 - Do not send ON. Send OFF if the VOC is less than Level.",
+         1,
+         3,
+         1)},
+
+    // Noise level sensor settings
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "Noise Report Threshold",
+         "0 - Reports disabled. Send Report if the noise has changed after the last report. Value in dB.",
+         0,
+         105,
+         10)},
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     ZUNO_CONFIG_PARAMETER_INFO(
+         "Noise Level to send Basic Set",
+         "Send Basic Set if the noise has crossed the level up or down + hysteresis. Value in dB.",
+         38,
+         105,
+         80)},
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     ZUNO_CONFIG_PARAMETER_INFO("Noise Hysteresis to send Basic Set", "Value in dB.", 1, 50, 5)},
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     ZUNO_CONFIG_PARAMETER_INFO("Noise ON command", "Send Basic Set command.", 0, 255, 255)},
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     ZUNO_CONFIG_PARAMETER_INFO("Noise OFF command", "Send Basic Set command.", 0, 255, 0)},
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     ZUNO_CONFIG_PARAMETER_INFO("Noise ON/OFF commands rules",
+                                "1 - Send ON if the noise is greater than Level. Send OFF if the noise is less than "
+                                "Level. 2 - Send ON if the noise is greater than Level. Do not send OFF. 3 - Do not "
+                                "send ON. Send OFF if the noise is less than Level.",
+                                1,
+                                3,
+                                1)},
+
+    // Intrusion sensor settings
+    {TZWAVEChannel::Type::INTRUSION,
+     ZUNO_CONFIG_PARAMETER_INFO("Intrusion Noise Level",
+                                "Send Alarm if the noise more level. Value in dB.",
+                                38,
+                                105,
+                                80)},
+    {TZWAVEChannel::Type::INTRUSION,
+     ZUNO_CONFIG_PARAMETER_INFO("Intrusion delay to send OFF command", "Value in seconds.", 0, 100000, 5)},
+
+    // Maximum age of values sent on controller requests
+    {TZWAVEChannel::Type::TEMPERATURE, WB_MSW_CONFIG_PARAMETER_INFO_MAX_VALUE_AGE("Temperature")},
+    {TZWAVEChannel::Type::HUMIDITY, WB_MSW_CONFIG_PARAMETER_INFO_MAX_VALUE_AGE("Humidity")},
+    {TZWAVEChannel::Type::LUMEN, WB_MSW_CONFIG_PARAMETER_INFO_MAX_VALUE_AGE("Luminance")},
+    {TZWAVEChannel::Type::CO2, WB_MSW_CONFIG_PARAMETER_INFO_MAX_VALUE_AGE("CO2")},
+    {TZWAVEChannel::Type::VOC, WB_MSW_CONFIG_PARAMETER_INFO_MAX_VALUE_AGE("VOC")},
+    {TZWAVEChannel::Type::NOISE_LEVEL, WB_MSW_CONFIG_PARAMETER_INFO_MAX_VALUE_AGE("Noise Level")},
+
+    // Reports rate limits
+    {DeviceWideParameterType,
+     ZUNO_CONFIG_PARAMETER_INFO("Reports Rate Limit",
+                                "0 - Unlimited. Frames per minute for the whole device. Reports over the limit are "
+                                "delayed and send the latest value. Motion and intrusion are never delayed.",
+                                0,
+                                600,
+                                60)},
+    {TZWAVEChannel::Type::TEMPERATURE, WB_MSW_CONFIG_PARAMETER_INFO_REPORTS_RATE_LIMIT("Temperature")},
+    {TZWAVEChannel::Type::HUMIDITY, WB_MSW_CONFIG_PARAMETER_INFO_REPORTS_RATE_LIMIT("Humidity")},
+    {TZWAVEChannel::Type::LUMEN, WB_MSW_CONFIG_PARAMETER_INFO_REPORTS_RATE_LIMIT("Luminance")},
+    {TZWAVEChannel::Type::CO2, WB_MSW_CONFIG_PARAMETER_INFO_REPORTS_RATE_LIMIT("CO2")},
+    {TZWAVEChannel::Type::VOC, WB_MSW_CONFIG_PARAMETER_INFO_REPORTS_RATE_LIMIT("VOC")},
+    {TZWAVEChannel::Type::NOISE_LEVEL, WB_MSW_CONFIG_PARAMETER_INFO_REPORTS_RATE_LIMIT("Noise Level")},
+
+    // Periodic reports of unchanged values
+    {TZWAVEChannel::Type::TEMPERATURE, WB_MSW_CONFIG_PARAMETER_INFO_MAX_REPORT_INTERVAL("Temperature")},
+    {TZWAVEChannel::Type::HUMIDITY, WB_MSW_CONFIG_PARAMETER_INFO_MAX_REPORT_INTERVAL("Humidity")},
+    {TZWAVEChannel::Type::LUMEN, WB_MSW_CONFIG_PARAMETER_INFO_MAX_REPORT_INTERVAL("Luminance")},
+    {TZWAVEChannel::Type::CO2, WB_MSW_CONFIG_PARAMETER_INFO_MAX_REPORT_INTERVAL("CO2")},
+    {TZWAVEChannel::Type::VOC, WB_MSW_CONFIG_PARAMETER_INFO_MAX_REPORT_INTERVAL("VOC")},
+    {TZWAVEChannel::Type::NOISE_LEVEL, WB_MSW_CONFIG_PARAMETER_INFO_MAX_REPORT_INTERVAL("Noise Level")},
+
+    // Filtering of the values read from the sensors
+    {TZWAVEChannel::Type::TEMPERATURE, WB_MSW_CONFIG_PARAMETER_INFO_MEDIAN_FILTER_SIZE("Temperature")},
+    {TZWAVEChannel::Type::HUMIDITY, WB_MSW_CONFIG_PARAMETER_INFO_MEDIAN_FILTER_SIZE("Humidity")},
+    {TZWAVEChannel::Type::LUMEN, WB_MSW_CONFIG_PARAMETER_INFO_MEDIAN_FILTER_SIZE("Luminance")},
+    {TZWAVEChannel::Type::CO2, WB_MSW_CONFIG_PARAMETER_INFO_MEDIAN_FILTER_SIZE("CO2")},
+    {TZWAVEChannel::Type::VOC, WB_MSW_CONFIG_PARAMETER_INFO_MEDIAN_FILTER_SIZE("VOC")},
+    {TZWAVEChannel::Type::NOISE_LEVEL, WB_MSW_CONFIG_PARAMETER_INFO_MEDIAN_FILTER_SIZE("Noise Level")},
+    {TZWAVEChannel::Type::TEMPERATURE, WB_MSW_CONFIG_PARAMETER_INFO_SMOOTHING_TIME("Temperature")},
+    {TZWAVEChannel::Type::HUMIDITY, WB_MSW_CONFIG_PARAMETER_INFO_SMOOTHING_TIME("Humidity")},
+    {TZWAVEChannel::Type::LUMEN, WB_MSW_CONFIG_PARAMETER_INFO_SMOOTHING_TIME("Luminance")},
+    {TZWAVEChannel::Type::CO2, WB_MSW_CONFIG_PARAMETER_INFO_SMOOTHING_TIME("CO2")},
+    {TZWAVEChannel::Type::VOC, WB_MSW_CONFIG_PARAMETER_INFO_SMOOTHING_TIME("VOC")},
+    {TZWAVEChannel::Type::NOISE_LEVEL, WB_MSW_CONFIG_PARAMETER_INFO_SMOOTHING_TIME("Noise Level")},
+
+    // Report rules
+    {TZWAVEChannel::Type::TEMPERATURE, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE("Temperature")},
+    {TZWAVEChannel::Type::HUMIDITY, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE("Humidity")},
+    {TZWAVEChannel::Type::LUMEN, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE("Luminance")},
+    {TZWAVEChannel::Type::CO2, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE("CO2")},
+    {TZWAVEChannel::Type::VOC, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE("VOC")},
+    {TZWAVEChannel::Type::NOISE_LEVEL, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE("Noise Level")},
+    {TZWAVEChannel::Type::TEMPERATURE, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE_THRESHOLD("Temperature", "0.01C")},
+    {TZWAVEChannel::Type::HUMIDITY, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE_THRESHOLD("Humidity", "%")},
+    {TZWAVEChannel::Type::LUMEN, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE_THRESHOLD("Luminance", "lux")},
+    {TZWAVEChannel::Type::CO2, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE_THRESHOLD("CO2", "ppm")},
+    {TZWAVEChannel::Type::VOC, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE_THRESHOLD("VOC", "ppb")},
+    {TZWAVEChannel::Type::NOISE_LEVEL, WB_MSW_CONFIG_PARAMETER_INFO_REPORT_MODE_THRESHOLD("Noise Level", "dB")},
+
+    // Statistics over time windows
+    {DeviceWideParameterType,
+     ZUNO_CONFIG_PARAMETER_INFO("Statistics Window",
+                                "0 - Statistics disabled. Length of the windows the minimum, maximum and mean "
+                                "values are computed over. Value in 15 minutes (4 = 1 hour).",
+                                0,
+                                96,
+                                0)},
+    {DeviceWideParameterType,
+     ZUNO_CONFIG_PARAMETER_INFO("Statistics Channel",
+                                "Channel the statistics parameters show. 0 - Temperature, 1 - Humidity, "
+                                "2 - Luminance, 3 - CO2, 4 - VOC, 5 - Noise Level.",
+                                0,
+                                5,
+                                0)},
+    {DeviceWideParameterType,
+     WB_MSW_CONFIG_PARAMETER_INFO_READ_ONLY("Statistics Minimum",
+                                            "Minimum value of the Statistics Channel within the last window, in the "
+                                            "units of the channel value with its precision. -2147483648 - no values.")},
+    {DeviceWideParameterType,
+     WB_MSW_CONFIG_PARAMETER_INFO_READ_ONLY("Statistics Maximum",
+                                            "Maximum value of the Statistics Channel within the last window, in the "
+                                            "units of the channel value with its precision. -2147483648 - no values.")},
+    {DeviceWideParameterType,
+     WB_MSW_CONFIG_PARAMETER_INFO_READ_ONLY("Statistics Mean",
+                                            "Mean value of the Statistics Channel within the last window, in the "
+                                            "units of the channel value with its precision. -2147483648 - no values.")},
+
+    // Computed channels settings
+    {TZWAVEChannel::Type::DEW_POINT,
+     ZUNO_CONFIG_PARAMETER_INFO("Dew Point Report Threshold",
+                                "0 - Reports disabled. Send Report if the dew point has changed after the last "
+                                "report. Value in 0.01C (100 = 1C).",
+                                0,
+                                4000,
+                                100)},
+    {TZWAVEChannel::Type::ABSOLUTE_HUMIDITY,
+     ZUNO_CONFIG_PARAMETER_INFO("Absolute Humidity Report Threshold",
+                                "0 - Reports disabled. Send Report if the absolute humidity has changed after the "
+                                "last report. Value in 0.01 g/m3 (100 = 1 g/m3).",
+                                0,
+                                5000,
+                                100)},
+    {TZWAVEChannel::Type::AIR_QUALITY,
+     ZUNO_CONFIG_PARAMETER_INFO("Air Quality Index Report Threshold",
+                                "0 - Reports disabled. Send Report if the air quality index (0 - excellent, 300 - "
+                                "unhealthy) has changed after the last report.",
+                                0,
+                                300,
+                                10)},
+
+    // Equivalent sound level settings
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     ZUNO_CONFIG_PARAMETER_INFO("Noise Level Leq Window",
+                                "0 - The noise level is sampled once per poll cycle and reported as is. Otherwise "
+                                "it is sampled several times per second and the equivalent continuous sound level "
+                                "(Leq) over the window is reported. Value in seconds.",
+                                0,
+                                3600,
+                                0)},
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     WB_MSW_CONFIG_PARAMETER_INFO_READ_ONLY("Noise Level Maximum",
+                                            "Maximum noise level (Lmax) within the last Leq windows of at least "
+                                            "15 minutes. Value in 0.01 dB.")},
+    {TZWAVEChannel::Type::NOISE_LEVEL,
+     WB_MSW_CONFIG_PARAMETER_INFO_READ_ONLY("Noise Level Minimum",
+                                            "Minimum noise level (Lmin) within the last Leq windows of at least "
+                                            "15 minutes. Value in 0.01 dB.")}
+};
+
+// Channels computed from the values of other channels read in the same poll cycle, with no Modbus transactions
+typedef struct
+{
+    TZWAVEChannel::Type ChannelType;
+    TZWAVEChannel::Type Sources[2];
+    int32_t (*Compute)(int32_t first, int32_t second);
+} TZWAVEDerivedChannel;
+
+static const TZWAVEDerivedChannel DerivedChannels[] = {
+    {TZWAVEChannel::Type::DEW_POINT,
+     {TZWAVEChannel::Type::TEMPERATURE, TZWAVEChannel::Type::HUMIDITY},
+     &WbMswDewPoint},
+    {TZWAVEChannel::Type::ABSOLUTE_HUMIDITY,
+     {TZWAVEChannel::Type::TEMPERATURE, TZWAVEChannel::Type::HUMIDITY},
+     &WbMswAbsoluteHumidity},
+    {TZWAVEChannel::Type::AIR_QUALITY, {TZWAVEChannel::Type::CO2, TZWAVEChannel::Type::VOC}, &WbMswAirQualityIndex},
+};
+
+static bool IsDerivedChannel(TZWAVEChannel::Type type)
+{
+    return static_cast<size_t>(type) >= static_cast<size_t>(TZWAVEChannel::Type::DEW_POINT);
+}
+
+static_assert(WB_MSW_CHANNEL_TYPES_MAX == TZWAVEChannel::CHANNEL_TYPES_COUNT, "Channel types count mismatch");
+static_assert(WB_MSW_BASIC_SET_GROUPS_MAX ==
+                  TZWAVEChannel::CHANNEL_TYPES_COUNT - 2 - sizeof(DerivedChannels) / sizeof(DerivedChannels[0]),
+              "Basic Set groups count mismatch, see ChannelsInitialize()");
+static_assert(WB_MSW_SERVER_CHANNELS_MAX > TZWAVEChannel::CHANNEL_TYPES_COUNT,
+              "Each server channel number must have a reports budget");
+
+static_assert(sizeof(Parameters) / sizeof(Parameters[0]) == WB_MSW_MAX_CONFIG_PARAM,
+              "Each configuration parameter must have a description");
+static_assert(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MAX_VALUE_AGE - WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MAX_VALUE_AGE ==
+                  static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL),
+              "Analog channels parameters must follow TZWAVEChannel::Type order");
+static_assert(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_REPORTS_RATE_LIMIT -
+                      WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORTS_RATE_LIMIT ==
+                  static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL),
+              "Analog channels parameters must follow TZWAVEChannel::Type order");
+static_assert(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MAX_REPORT_INTERVAL -
+                      WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MAX_REPORT_INTERVAL ==
+                  static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL),
+              "Analog channels parameters must follow TZWAVEChannel::Type order");
+static_assert(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MEDIAN_FILTER_SIZE -
+                      WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MEDIAN_FILTER_SIZE ==
+                  static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL),
+              "Analog channels parameters must follow TZWAVEChannel::Type order");
+static_assert(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_SMOOTHING_TIME - WB_MSW_CONFIG_PARAMETER_TEMPERATURE_SMOOTHING_TIME ==
+                  static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL),
+              "Analog channels parameters must follow TZWAVEChannel::Type order");
+static_assert(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_REPORT_MODE - WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORT_MODE ==
+                  static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL),
+              "Analog channels parameters must follow TZWAVEChannel::Type order");
+static_assert(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_REPORT_MODE_THRESHOLD -
+                      WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORT_MODE_THRESHOLD ==
+                  static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL),
+              "Analog channels parameters must follow TZWAVEChannel::Type order");
+static_assert(TZWAVEChannel::CHANNEL_TYPES_COUNT < WB_MSW_SERVER_CHANNELS_MAX,
+              "Each server channel must have its reports rate limit");
+
+// Returns the parameter of an analog channel from the group starting with firstParameterNumber, 0 - not analog channel
+static uint8_t GetAnalogChannelParameterNumber(TZWAVEChannel::Type type, uint8_t firstParameterNumber)
+{
+    if (static_cast<size_t>(type) > static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL)) {
+        return 0;
+    }
+    return firstParameterNumber + static_cast<size_t>(type);
+}
+
 TZWAVESensor::TZWAVESensor(TWBMSWSensor* wbMsw): WbMsw(wbMsw)
 {
-    // Available device parameters description
-    // Channels in the device are created dynamically, so parameters are described in "dynamic" style
-    ZunoCFGParameter_t parameters[WB_MSW_MAX_CONFIG_PARAM] = {
-
-        // Motion sensor settings
-        ZUNO_CONFIG_PARAMETER_INFO("Motion delay to send OFF command", "Value in seconds.", 0, 100000, 60),
-        ZUNO_CONFIG_PARAMETER_INFO("Motion ON command", "Send Basic Set command.", 0, 255, 255),
-        ZUNO_CONFIG_PARAMETER_INFO("Motion OFF command", "Send Basic Set command.", 0, 255, 0),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "Motion ON/OFF commands rules",
-            "1 - Send ON if the motion is detected. Send OFF if the motion is idle. 2 - Send ON if the motion is "
-            "detected. Do not send OFF. 3 - Do not send ON. Send OFF if the motion is idle.",
-            1,
-            3,
-            1),
-
-        // Temperature channel settings
-        ZUNO_CONFIG_PARAMETER_INFO("Temperature Report Threshold",
-                                   "0 - Reports disabled. Send Report if the temperature has changed after the last "
-                                   "report. Value in 0.01C (100 = 1C).",
-                                   0,
-                                   4000,
-                                   100),
-        ZUNO_CONFIG_PARAMETER_INFO_SIGN("Temperature Level to send Basic Set",
-                                        "Send Basic Set if the temperature has crossed the level up or down + "
-                                        "hysteresis. Value in 0.01C (100 = 1C).",
-                                        -4000,
-                                        8000,
-                                        4000),
-        ZUNO_CONFIG_PARAMETER_INFO("Temperature Hysteresis to send Basic Set",
-                                   "Value in 0.01C (100 = 1C).",
-                                   10,
-                                   2000,
-                                   50),
-        ZUNO_CONFIG_PARAMETER_INFO("Temperature ON command", "Send Basic Set command.", 0, 255, 255),
-        ZUNO_CONFIG_PARAMETER_INFO("Temperature OFF command", "Send Basic Set command.", 0, 255, 0),
-        ZUNO_CONFIG_PARAMETER_INFO("Temperature ON/OFF commands rules",
-                                   "1 - Send ON if the temperature is greater than Level. Send OFF if the temperature "
-                                   "is less than Level. 2 - Send ON if the temperature is greater than Level. Do not "
-                                   "send OFF. 3 - Do not send ON. Send OFF if the temperature is less than Level.",
-                                   1,
-                                   3,
-                                   1),
-
-        // Humidity sensor settings
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "Humidity Report Threshold",
-            "0 - Reports disabled. Send Report if the humidity has changed after the last report. Value in %.",
-            0,
-            90,
-            5),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "Humidity Level to send Basic Set",
-            "Send Basic Set if the humidity has crossed the level up or down + hysteresis. Value in %.",
-            5,
-            95,
-            60),
-        ZUNO_CONFIG_PARAMETER_INFO("Humidity Hysteresis to send Basic Set", "Value in %.", 1, 50, 2),
-        ZUNO_CONFIG_PARAMETER_INFO("Humidity ON command", "Send Basic Set command.", 0, 255, 255),
-        ZUNO_CONFIG_PARAMETER_INFO("Humidity OFF command", "Send Basic Set command.", 0, 255, 0),
-        ZUNO_CONFIG_PARAMETER_INFO("Humidity ON/OFF commands rules",
-                                   "1 - Send ON if the humidity is greater than Level. Send OFF if the humidity is "
-                                   "less than Level. 2 - Send ON if the humidity is greater than Level. Do not send "
-                                   "OFF. 3 - Do not send ON. Send OFF if the humidity is less than Level.",
-                                   1,
-                                   3,
-                                   1),
-
-        // Lumen sensor settings
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "Luminance Report Threshold",
-            "0 - Reports disabled. Send Report if the luminance has changed after the last report. Value in lux.",
-            0,
-            100000,
-            100),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "Luminance Level to send Basic Set",
-            "Send Basic Set if the luminance has crossed the level up or down + hysteresis. Value in lux.",
-            0,
-            100000,
-            200),
-        ZUNO_CONFIG_PARAMETER_INFO("Luminance Hysteresis to send Basic Set", "Value in lux.", 1, 50000, 50),
-        ZUNO_CONFIG_PARAMETER_INFO("Luminance ON command", "Send Basic Set command.", 0, 255, 255),
-        ZUNO_CONFIG_PARAMETER_INFO("Luminance OFF command", "Send Basic Set command.", 0, 255, 0),
-        ZUNO_CONFIG_PARAMETER_INFO("Luminance ON/OFF commands rules",
-                                   "1 - Send ON if the luminance is greater than Level. Send OFF if the luminance is "
-                                   "less than Level. 2 - Send ON if the luminance is greater than Level. Do not send "
-                                   "OFF. 3 - Do not send ON. Send OFF if the luminance is less than Level.",
-                                   1,
-                                   3,
-                                   1),
-
-        // CO2 sensor settings
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "CO2 Report Threshold",
-            "0 - Reports disabled. Send Report if the CO2 has changed after the last report. Value in ppm.",
-            0,
-            5000,
-            100),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "CO2 Level to send Basic Set",
-            "Send Basic Set if the CO2 has crossed the level up or down + hysteresis. Value in ppm.",
-            400,
-            5000,
-            1500),
-        ZUNO_CONFIG_PARAMETER_INFO("CO2 Hysteresis to send Basic Set", "Value in ppm.", 1, 2500, 50),
-        ZUNO_CONFIG_PARAMETER_INFO("CO2 ON command", "Send Basic Set command.", 0, 255, 255),
-        ZUNO_CONFIG_PARAMETER_INFO("CO2 OFF command", "Send Basic Set command.", 0, 255, 0),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "CO2 ON/OFF commands rules",
-            "1 - Send ON if the CO2 is greater than Level. Send OFF if the CO2 is less than Level. 2 - Send ON if the "
-            "CO2 is greater than Level. Do not send OFF. 3 - Do not send ON. Send OFF if the CO2 is less than Level.",
-            1,
-            3,
-            1),
-
-        // VOC sensor settings
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "VOC Report Threshold",
-            "0 - Reports disabled. Send Report if the VOC has changed after the last report. Value in ppb.",
-            0,
-            60000,
-            200),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "VOC Level to send Basic Set",
-            "Send Basic Set if the VOC has crossed the level up or down + hysteresis. Value in ppb.",
-            0,
-            60000,
-            660),
-        ZUNO_CONFIG_PARAMETER_INFO("VOC Hysteresis to send Basic Set", "Value in ppb.", 1, 30000, 200),
-        ZUNO_CONFIG_PARAMETER_INFO("VOC ON command", "Send Basic Set command.", 0, 255, 255),
-        ZUNO_CONFIG_PARAMETER_INFO("VOC OFF command", "Send Basic Set command.", 0, 255, 0),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "VOC ON/OFF commands rules",
-            "1 - Send ON if the VOC is greater than Level. Send OFF if the VOC is less than Level. 2 - Send ON if the "
-            "VOC is greater than Level. Do not send OFF. 3 - Do not send ON. Send OFF if the VOC is less than Level.",
-            1,
-            3,
-            1),
-
-        // Noise level sensor settings
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "Noise Report Threshold",
-            "0 - Reports disabled. Send Report if the noise has changed after the last report. Value in dB.",
-            0,
-            105,
-            10),
-        ZUNO_CONFIG_PARAMETER_INFO(
-            "Noise Level to send Basic Set",
-            "Send Basic Set if the noise has crossed the level up or down + hysteresis. Value in dB.",
-            38,
-            105,
-            80),
-        ZUNO_CONFIG_PARAMETER_INFO("Noise Hysteresis to send Basic Set", "Value in dB.", 1, 50, 5),
-        ZUNO_CONFIG_PARAMETER_INFO("Noise ON command", "Send Basic Set command.", 0, 255, 255),
-        ZUNO_CONFIG_PARAMETER_INFO("Noise OFF command", "Send Basic Set command.", 0, 255, 0),
-        ZUNO_CONFIG_PARAMETER_INFO("Noise ON/OFF commands rules",
-                                   "1 - Send ON if the noise is greater than Level. Send OFF if the noise is less than "
-                                   "Level. 2 - Send ON if the noise is greater than Level. Do not send OFF. 3 - Do not "
-                                   "send ON. Send OFF if the noise is less than Level.",
-                                   1,
-                                   3,
-                                   1),
-
-        // Intrusion sensor settings
-        ZUNO_CONFIG_PARAMETER_INFO("Intrusion Noise Level",
-                                   "Send Alarm if the noise more level. Value in dB.",
-                                   38,
-                                   105,
-                                   80),
-        ZUNO_CONFIG_PARAMETER_INFO("Intrusion delay to send OFF command", "Value in seconds.", 0, 100000, 5)
-
-    };
-    memcpy(Parameters, parameters, sizeof(parameters));
+    ParametersState = 0;
+    ParameterValuesSequence = 0;
+    ParameterResets = 0;
     MotionLastTimeWaitOff = false;
     IntrusionLastTimeWaitOff = false;
+    Updating = false;
+    AvailabilityCheckTime = 0;
+    FreshValueRequests = 0;
+    DeferredReports = 0;
+    DroppedReports = 0;
+    StatisticsTime = 0;
+    StatisticsWindowMs = 0;
+    SoundLevelTime = 0;
+    SoundLevelWindowMs = 0;
+    NoiseSampleTime = 0;
+    NoiseExtremesTime = 0;
+    MotionPeak = 0;
+    MotionPeakValid = false;
+    MotionSampleTime = 0;
 }
 
 // Function determines number of available Z-Wave device channels (EndPoints) and fills in the structures by channel
 // type
-bool TZWAVESensor::ChannelsInitialize()
+bool TZWAVESensor::LoadEndpointsLayout(uint16_t& endpoints)
+{
+    TZWAVESensor::EndpointsLayout layout;
+    zunoEEPROMRead(WB_MSW_EEPROM_ENDPOINTS_LAYOUT_ADDRESS, sizeof(layout), &layout);
+    if (layout.Magic != WB_MSW_EEPROM_ENDPOINTS_LAYOUT_MAGIC) {
+        return false;
+    }
+    endpoints = layout.Endpoints;
+    return true;
+}
+
+// The layout is built on every boot until the device is included, so it is written only when it changes
+void TZWAVESensor::SaveEndpointsLayout(uint16_t endpoints)
+{
+    uint16_t savedEndpoints;
+    if (LoadEndpointsLayout(savedEndpoints) && savedEndpoints == endpoints) {
+        return;
+    }
+    TZWAVESensor::EndpointsLayout layout = {WB_MSW_EEPROM_ENDPOINTS_LAYOUT_MAGIC, endpoints};
+    zunoEEPROMWrite(WB_MSW_EEPROM_ENDPOINTS_LAYOUT_ADDRESS, sizeof(layout), &layout);
+}
+
+// Endpoints are assigned to the available sensors when the device is included into a network and kept until
+// exclusion. A sensor missing at boot leaves its endpoint unavailable instead of shifting the following ones
+bool TZWAVESensor::ChannelsInitialize(bool newLayout)
 {
     uint32_t startTime = millis();
     uint32_t lastTime = startTime;
@@ -329,6 +699,52 @@ bool TZWAVESensor::ChannelsInitialize()
                                   NULL,
                                   &TWBMSWSensor::BuzzerAvailable);
 
+    Channels[9].ChannelInitialize("DewPoint",
+                                  TZWAVEChannel::Type::DEW_POINT,
+                                  WB_MSW_DEW_POINT_VALUE_ERROR,
+                                  WB_MSW_CONFIG_PARAMETER_DEW_POINT_REPORT_THRESHOLD,
+                                  0,
+                                  0,
+                                  0,
+                                  0,
+                                  0,
+                                  WB_MSW_CONFIG_PARAMETER_DEW_POINT_MULTIPLIER,
+                                  WbMsw,
+                                  NULL,
+                                  &TWBMSWSensor::GetClimateAvailability);
+
+    Channels[10].ChannelInitialize("AbsoluteHumidity",
+                                   TZWAVEChannel::Type::ABSOLUTE_HUMIDITY,
+                                   WB_MSW_ABSOLUTE_HUMIDITY_VALUE_ERROR,
+                                   WB_MSW_CONFIG_PARAMETER_ABSOLUTE_HUMIDITY_REPORT_THRESHOLD,
+                                   0,
+                                   0,
+                                   0,
+                                   0,
+                                   0,
+                                   WB_MSW_CONFIG_PARAMETER_ABSOLUTE_HUMIDITY_MULTIPLIER,
+                                   WbMsw,
+                                   NULL,
+                                   &TWBMSWSensor::GetClimateAvailability);
+
+    Channels[11].ChannelInitialize("AirQuality",
+                                   TZWAVEChannel::Type::AIR_QUALITY,
+                                   WB_MSW_AIR_QUALITY_VALUE_ERROR,
+                                   WB_MSW_CONFIG_PARAMETER_AIR_QUALITY_REPORT_THRESHOLD,
+                                   0,
+                                   0,
+                                   0,
+                                   0,
+                                   0,
+                                   WB_MSW_CONFIG_PARAMETER_AIR_QUALITY_MULTIPLIER,
+                                   WbMsw,
+                                   NULL,
+                                   &TWBMSWSensor::GetAirQualityAvailability);
+
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        ChannelsByType[static_cast<size_t>(Channels[i].GetType())] = &Channels[i];
+    }
+
     bool unknownSensorsLeft = false;
 
     do {
@@ -337,24 +753,9 @@ bool TZWAVESensor::ChannelsInitialize()
             if (Channels[i].GetAvailability() == TWBMSWSensor::Availability::UNKNOWN) {
                 Channels[i].UpdateAvailability();
                 if (Channels[i].GetAvailability() == TWBMSWSensor::Availability::AVAILABLE) {
-
-                    if ((Channels[i].GetType() == TZWAVEChannel::Type::CO2) &&
-                        (!Channels[i].SetPowerOn() ||
-                         !Channels[i].SetAutocalibration(WB_MSW_CONFIG_PARAMETER_CO2_AUTO_VALUE)))
-                    {
+                    if (!EnableChannel(Channels[i])) {
                         break;
                     }
-
-                    if (Channels[i].GetType() == TZWAVEChannel::Type::MOTION) {
-                        MotionChannelPtr = &Channels[i];
-                    }
-
-                    if (Channels[i].GetType() == TZWAVEChannel::Type::INTRUSION) {
-                        IntrusionChannelPtr = &Channels[i];
-                    }
-                    DEBUG(Channels[i].GetName());
-                    DEBUG(" CHANNEL AVAILABLE\n");
-                    Channels[i].Enable();
                 }
             }
         }
@@ -366,13 +767,30 @@ bool TZWAVESensor::ChannelsInitialize()
         }
     } while ((lastTime - startTime <= timeout) && unknownSensorsLeft);
 
+    uint16_t endpoints = 0;
+    if (newLayout || !LoadEndpointsLayout(endpoints)) {
+        endpoints = 0;
+        for (int i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+            if (Channels[i].GetEnabled()) {
+                endpoints |= 1 << static_cast<size_t>(Channels[i].GetType());
+            }
+        }
+        SaveEndpointsLayout(endpoints);
+    }
+
     uint8_t channelsCount = 0;
     uint8_t channelDeviceNumber = 0;
     size_t groupIndex = CTRL_GROUP_1;
     for (int i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
-        if (Channels[i].GetEnabled()) {
+        Channels[i].SetEndpoint(endpoints & (1 << static_cast<size_t>(Channels[i].GetType())));
+        if (Channels[i].HasEndpoint()) {
+            if (!Channels[i].GetEnabled()) {
+                DEBUG(Channels[i].GetName());
+                DEBUG(" CHANNEL UNAVAILABLE\n");
+            }
+            // Computed channels have no Basic Set group, so the groups of the sensors keep their numbers
             if (Channels[i].GetType() == TZWAVEChannel::Type::INTRUSION ||
-                Channels[i].GetType() == TZWAVEChannel::Type::BUZZER)
+                Channels[i].GetType() == TZWAVEChannel::Type::BUZZER || IsDerivedChannel(Channels[i].GetType()))
             {
                 Channels[i].SetChannelNumbers(channelDeviceNumber, channelDeviceNumber + 1, 0xFF);
             } else {
@@ -381,6 +799,9 @@ bool TZWAVESensor::ChannelsInitialize()
             }
             channelDeviceNumber++;
             channelsCount++;
+        } else {
+            // A sensor appeared after the inclusion has no endpoint to report to
+            Channels[i].Disable();
         }
     }
 
@@ -392,7 +813,7 @@ void TZWAVESensor::ChannelsSetup()
 {
 
     for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
-        if (Channels[i].GetEnabled()) {
+        if (Channels[i].HasEndpoint()) {
             switch (Channels[i].GetType()) {
                 case TZWAVEChannel::Type::TEMPERATURE:
                     zunoAddChannel(
@@ -462,6 +883,30 @@ void TZWAVESensor::ChannelsSetup()
                     zunoAddChannel(ZUNO_SOUND_SWITCH_CHANNEL_NUMBER, 50, 0);
                     zunoSetZWChannel(Channels[i].GetDeviceChannelNumber(), Channels[i].GetServerChannelNumber());
                     break;
+                case TZWAVEChannel::Type::DEW_POINT:
+                    zunoAddChannel(ZUNO_SENSOR_MULTILEVEL_CHANNEL_NUMBER,
+                                   ZUNO_SENSOR_MULTILEVEL_TYPE_DEW_POINT,
+                                   (SENSOR_MULTILEVEL_PROPERTIES_COMBINER(SENSOR_MULTILEVEL_SCALE_CELSIUS,
+                                                                          WB_MSW_DEW_POINT_VALUE_SIZE,
+                                                                          WB_MSW_DEW_POINT_VALUE_PRECISION)));
+                    zunoSetZWChannel(Channels[i].GetDeviceChannelNumber(), Channels[i].GetServerChannelNumber());
+                    break;
+                case TZWAVEChannel::Type::ABSOLUTE_HUMIDITY:
+                    zunoAddChannel(ZUNO_SENSOR_MULTILEVEL_CHANNEL_NUMBER,
+                                   ZUNO_SENSOR_MULTILEVEL_TYPE_RELATIVE_HUMIDITY,
+                                   (SENSOR_MULTILEVEL_PROPERTIES_COMBINER(WB_MSW_ABSOLUTE_HUMIDITY_SCALE,
+                                                                          WB_MSW_ABSOLUTE_HUMIDITY_VALUE_SIZE,
+                                                                          WB_MSW_ABSOLUTE_HUMIDITY_VALUE_PRECISION)));
+                    zunoSetZWChannel(Channels[i].GetDeviceChannelNumber(), Channels[i].GetServerChannelNumber());
+                    break;
+                case TZWAVEChannel::Type::AIR_QUALITY:
+                    zunoAddChannel(ZUNO_SENSOR_MULTILEVEL_CHANNEL_NUMBER,
+                                   ZUNO_SENSOR_MULTILEVEL_TYPE_GENERAL_PURPOSE_VALUE,
+                                   (SENSOR_MULTILEVEL_PROPERTIES_COMBINER(WB_MSW_AIR_QUALITY_SCALE,
+                                                                          WB_MSW_AIR_QUALITY_VALUE_SIZE,
+                                                                          WB_MSW_AIR_QUALITY_VALUE_PRECISION)));
+                    zunoSetZWChannel(Channels[i].GetDeviceChannelNumber(), Channels[i].GetServerChannelNumber());
+                    break;
                 default:
                     break;
             }
@@ -473,13 +918,13 @@ void TZWAVESensor::ChannelsSetup()
 }
 
 // Setting up handlers for all sensor cannels. Handler is used when requesting channel data from controller
-// Function binds i-channel directly to value
-void TZWAVESensor::SetChannelHandlers()
+// Values are read through the getter, so a request arriving while the poll loop updates the value never sees it torn
+void TZWAVESensor::SetChannelHandlers(void* valueGetter)
 {
     for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
         if (Channels[i].GetType() == TZWAVEChannel::Type::BUZZER)
             continue;
-        if (Channels[i].GetEnabled()) {
+        if (Channels[i].HasEndpoint()) {
             uint8_t dataSize;
             switch (Channels[i].GetType()) {
                 case TZWAVEChannel::Type::LUMEN:
@@ -497,17 +942,80 @@ void TZWAVESensor::SetChannelHandlers()
             }
             zunoAppendChannelHandler(Channels[i].GetDeviceChannelNumber(),
                                      dataSize,
-                                     CHANNEL_HANDLER_SINGLE_VALUEMAPPER,
-                                     Channels[i].GetValuePointer());
+                                     CHANNEL_HANDLER_MULTI_GETTER,
+                                     valueGetter);
+        }
+    }
+}
+
+// Returns the last published value of the channel with the given device channel number
+int32_t TZWAVESensor::GetChannelValue(uint8_t channelDeviceNumber)
+{
+    bool updating = __atomic_load_n(&Updating, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        if (Channels[i].HasEndpoint() && Channels[i].GetDeviceChannelNumber() == channelDeviceNumber) {
+            // Sensors don't measure anything while the sensor firmware is updated or are not available
+            if (updating || !Channels[i].GetEnabled()) {
+                return Channels[i].GetErrorValue();
+            }
+            return GetFreshChannelValue(i);
         }
     }
+    return 0;
+}
+
+// Returns the last polled value. If it is too old, asks the poll loop to read the channel out of turn,
+// the new value is reported when it is read
+int32_t TZWAVESensor::GetFreshChannelValue(size_t channelIndex)
+{
+    const TZWAVEChannel& channel = Channels[channelIndex];
+    uint32_t maxAge = __atomic_load_n(&channel.GetReportPolicy().MaxValueAgeMs, __ATOMIC_RELAXED);
+    uint32_t time;
+    int32_t value = channel.GetValue(time);
+    if (maxAge != 0 && millis() - time > maxAge) {
+        __atomic_fetch_or(&FreshValueRequests, 1UL << channelIndex, __ATOMIC_RELEASE);
+    }
+    return value;
+}
+
+// Sends the reports queued by the channels processing, as many as the radio accepts now
+void TZWAVESensor::ProcessReports()
+{
+    Reports.Process();
+    if (Reports.GetDeferred() != DeferredReports) {
+        DeferredReports = Reports.GetDeferred();
+        LOG_INT_VALUE("Deferred reports:   ", (long)DeferredReports);
+    }
+    // Call sites don't check the result of adding to the queue, the drops are counted by the queue itself
+    if (Reports.GetDropped() != DroppedReports) {
+        DroppedReports = Reports.GetDropped();
+        DEBUG("*** ERROR Report queue overflow, dropped ");
+        DEBUG(DroppedReports);
+        DEBUG(" reports\n");
+    }
+}
+
+// Reports delayed by the rate limits since the start
+uint32_t TZWAVESensor::GetDeferredReports() const
+{
+    return Reports.GetDeferred();
+}
+
+// Marks all channels as unavailable for the sensor firmware update time.
+// Motion is released before, so that the controller doesn't keep a stale motion state
+void TZWAVESensor::SetUpdating(bool updating)
+{
+    if (updating) {
+        MotionChannelReset(MotionChannelPtr);
+    }
+    __atomic_store_n(&Updating, updating, __ATOMIC_RELEASE);
 }
 
 // Sets by return value name of group by its index
 const char* TZWAVESensor::GetGroupNameByIndex(uint8_t groupIndex)
 {
     for (uint8_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
-        if (Channels[i].GetEnabled()) {
+        if (Channels[i].HasEndpoint()) {
             if (Channels[i].GetGroupIndex() == groupIndex) {
                 switch (Channels[i].GetType()) {
                     case TZWAVEChannel::Type::TEMPERATURE:
@@ -535,18 +1043,120 @@ const char* TZWAVESensor::GetGroupNameByIndex(uint8_t groupIndex)
 
 void TZWAVESensor::ParametersInitialize()
 {
-    // Load configuration parameters from FLASH memory
+    TZWAVESensor::ParameterSet parameters;
+    uint32_t state = __atomic_load_n(&ParametersState, __ATOMIC_ACQUIRE);
+    // The values are published once, then only the system thread writes them. After a reconnection of the sensor
+    // the poll loop takes the last published values, read-only ones are kept as it writes them itself
+    if (state & WB_MSW_PARAMETERS_PUBLISHED) {
+        ParameterValuesSequence = SharedParameterValues.Read(parameters);
+        for (size_t i = 0; i < WB_MSW_MAX_CONFIG_PARAM; i++) {
+            if (!Parameters[i].Description.readOnly || parameters.Resets != ParameterResets) {
+                ParameterValues[i] = parameters.Values[i];
+            }
+        }
+    } else {
+        // Load configuration parameters from FLASH memory. If the system thread resets the flash meanwhile,
+        // the values read may be the old ones, so they are read again
+        do {
+            for (size_t i = 0; i < WB_MSW_MAX_CONFIG_PARAM; i++) {
+                ParameterValues[i] = zunoLoadCFGParam(i + WB_MSW_CONFIG_PARAMETER_FIRST);
+                DEBUG("Parameter ");
+                DEBUG(i);
+                DEBUG(" value ");
+                DEBUG(ParameterValues[i]);
+                DEBUG("\n");
+            }
+            memcpy(parameters.Values, ParameterValues, sizeof(parameters.Values));
+            parameters.Resets = 0;
+            SharedParameterValues.Write(parameters);
+            ParameterValuesSequence = SharedParameterValues.GetSequence();
+        } while (!__atomic_compare_exchange_n(&ParametersState,
+                                              &state,
+                                              state | WB_MSW_PARAMETERS_PUBLISHED,
+                                              false,
+                                              __ATOMIC_ACQ_REL,
+                                              __ATOMIC_ACQUIRE));
+    }
+    ParameterResets = parameters.Resets;
+    UpdateDeviceSettings();
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        UpdateReportPolicy(Channels[i]);
+    }
+}
+
+// Restores the default values after the inclusion. It is called by the system thread before the controller can
+// configure the device, and the configuration handler publishes the values from the same thread.
+// Only the parameters which differ from their defaults are written to flash, and the poll loop takes
+// the whole default set at once on its next cycle
+void TZWAVESensor::ResetParameters()
+{
     for (size_t i = 0; i < WB_MSW_MAX_CONFIG_PARAM; i++) {
-        ParameterValues[i] = zunoLoadCFGParam(i + WB_MSW_CONFIG_PARAMETER_FIRST);
-        DEBUG("Parameter ");
-        DEBUG(i);
-        DEBUG(" value ");
-        DEBUG(ParameterValues[i]);
-        DEBUG("\n");
+        int32_t defaultValue = Parameters[i].Description.defaultValue;
+        if (zunoLoadCFGParam(i + WB_MSW_CONFIG_PARAMETER_FIRST) != defaultValue) {
+            zunoSaveCFGParam(i + WB_MSW_CONFIG_PARAMETER_FIRST, defaultValue);
+        }
     }
+    // The poll loop loads the defaults from flash if it hasn't published the values yet. The reset is counted,
+    // so that the values it has already read are read again
+    uint32_t state = __atomic_load_n(&ParametersState, __ATOMIC_ACQUIRE);
+    while (!(state & WB_MSW_PARAMETERS_PUBLISHED)) {
+        if (__atomic_compare_exchange_n(&ParametersState,
+                                        &state,
+                                        state + WB_MSW_PARAMETERS_FLASH_RESET,
+                                        false,
+                                        __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+        {
+            return;
+        }
+    }
+    TZWAVESensor::ParameterSet parameters = SharedParameterValues.Peek();
+    for (size_t i = 0; i < WB_MSW_MAX_CONFIG_PARAM; i++) {
+        parameters.Values[i] = Parameters[i].Description.defaultValue;
+    }
+    parameters.Resets++;
+    SharedParameterValues.Write(parameters);
 }
 
-// The handler is called when a configuration parameter value updated from Z-Wave controller
+// Takes a consistent snapshot of parameters changed by the controller and rebuilds policies of affected channels
+void TZWAVESensor::UpdateParameterValues()
+{
+    TZWAVESensor::ParameterSet parameters;
+    bool channelChanged[TZWAVEChannel::CHANNEL_TYPES_COUNT] = {false};
+    bool deviceChanged = false;
+
+    if (SharedParameterValues.GetSequence() == ParameterValuesSequence) {
+        return;
+    }
+    ParameterValuesSequence = SharedParameterValues.Read(parameters);
+    // Read-only parameters are written by the poll loop itself, it takes only their defaults after a reset
+    bool reset = parameters.Resets != ParameterResets;
+    ParameterResets = parameters.Resets;
+    for (size_t i = 0; i < WB_MSW_MAX_CONFIG_PARAM; i++) {
+        if (Parameters[i].Description.readOnly && !reset) {
+            continue;
+        }
+        if (ParameterValues[i] != parameters.Values[i]) {
+            ParameterValues[i] = parameters.Values[i];
+            if (Parameters[i].ChannelType == DeviceWideParameterType) {
+                deviceChanged = true;
+            } else {
+                channelChanged[static_cast<size_t>(Parameters[i].ChannelType)] = true;
+            }
+        }
+    }
+    if (deviceChanged) {
+        UpdateDeviceSettings();
+    }
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        if (channelChanged[i] && ChannelsByType[i]) {
+            UpdateReportPolicy(*ChannelsByType[i]);
+        }
+    }
+}
+
+// The handler is called when a configuration parameter value updated from Z-Wave controller.
+// It runs in the system handler context, so it only publishes the value for the poll loop and never waits
 void TZWAVESensor::SetParameterValue(size_t paramNumber, int32_t value)
 {
     // DEBUG("Set parameter ");
@@ -554,18 +1164,20 @@ void TZWAVESensor::SetParameterValue(size_t paramNumber, int32_t value)
     // DEBUG(" with value ");
     // DEBUG(value);
     // DEBUG("\n");
-    if (paramNumber < WB_MSW_CONFIG_PARAMETER_FIRST || paramNumber > WB_MSW_CONFIG_PARAMETER_LAST) {
+    if (paramNumber < WB_MSW_CONFIG_PARAMETER_FIRST || paramNumber >= WB_MSW_CONFIG_PARAMETER_LAST) {
         DEBUG("***ERROR Wrong parameter number!\n");
         return;
     }
-    ParameterValues[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST] = value;
+    TZWAVESensor::ParameterSet parameters = SharedParameterValues.Peek();
+    parameters.Values[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST] = value;
+    SharedParameterValues.Write(parameters);
 }
 
 int32_t TZWAVESensor::GetParameterValue(size_t paramNumber)
 {
     // DEBUG("Get parameter ");
     // DEBUG(paramNumber);
-    if (paramNumber < WB_MSW_CONFIG_PARAMETER_FIRST || paramNumber > WB_MSW_CONFIG_PARAMETER_LAST) {
+    if (paramNumber < WB_MSW_CONFIG_PARAMETER_FIRST || paramNumber >= WB_MSW_CONFIG_PARAMETER_LAST) {
         DEBUG("***ERROR Wrong parameter value number!\n");
         return 0;
     }
@@ -575,132 +1187,223 @@ int32_t TZWAVESensor::GetParameterValue(size_t paramNumber)
     return ParameterValues[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST];
 }
 
-ZunoCFGParameter_t* TZWAVESensor::GetParameterByNumber(size_t paramNumber)
+// Returns zero for parameters the channel doesn't have (parameter number 0)
+int32_t TZWAVESensor::GetChannelParameterValue(uint8_t paramNumber)
+{
+    if (paramNumber == 0) {
+        return 0;
+    }
+    return GetParameterValue(paramNumber);
+}
+
+// Resolves channel parameters into the scaled values compared against every new sample.
+// Called only when one of the channel parameters changes
+void TZWAVESensor::UpdateReportPolicy(TZWAVEChannel& channel)
+{
+    TZWAVEChannel::ReportPolicy policy;
+    int32_t multiplier = channel.GetMultiplier();
+    int32_t levelSendBasic = GetChannelParameterValue(channel.GetLevelSendBasicParameterNumber()) * multiplier;
+    int32_t hysteresisBasic = GetChannelParameterValue(channel.GetHysteresisBasicParameterNumber()) * multiplier;
+    int32_t onOffCommandsRule = GetChannelParameterValue(channel.GetOnOffCommandsRuleParameterNumber());
+
+    policy.ReportThresHold = GetChannelParameterValue(channel.GetReportThresHoldParameterNumber()) * multiplier;
+    policy.LevelOn = levelSendBasic + hysteresisBasic;
+    policy.LevelOff = levelSendBasic - hysteresisBasic;
+    policy.OnCommand = GetChannelParameterValue(channel.GetOnCommandsParameterNumber());
+    policy.OffCommand = GetChannelParameterValue(channel.GetOffCommandsParameterNumber());
+    policy.SendOnCommand = (onOffCommandsRule == 1 || onOffCommandsRule == 2);
+    policy.SendOffCommand = (onOffCommandsRule == 1 || onOffCommandsRule == 3);
+    switch (channel.GetType()) {
+        case TZWAVEChannel::Type::MOTION:
+            policy.OffDelayMs =
+                (uint32_t)GetParameterValue(WB_MSW_CONFIG_PARAMETER_MOTION_DELAY_SEND_OFF_COMMANDS) * 1000;
+            break;
+        case TZWAVEChannel::Type::INTRUSION:
+            policy.OffDelayMs =
+                (uint32_t)GetParameterValue(WB_MSW_CONFIG_PARAMETER_INTRUSION_DELAY_SEND_OFF_COMMANDS) * 1000;
+            break;
+        default:
+            policy.OffDelayMs = 0;
+            break;
+    }
+    policy.MaxValueAgeMs = (uint32_t)GetChannelParameterValue(GetAnalogChannelParameterNumber(
+                               channel.GetType(),
+                               WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MAX_VALUE_AGE)) *
+                           1000;
+    policy.MaxReportIntervalMs = (uint32_t)GetChannelParameterValue(GetAnalogChannelParameterNumber(
+                                     channel.GetType(),
+                                     WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MAX_REPORT_INTERVAL)) *
+                                 1000;
+    policy.Mode = static_cast<TZWAVEChannel::ReportMode>(GetChannelParameterValue(
+        GetAnalogChannelParameterNumber(channel.GetType(), WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORT_MODE)));
+    policy.ModeThreshold = GetChannelParameterValue(GetAnalogChannelParameterNumber(
+        channel.GetType(),
+        WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORT_MODE_THRESHOLD));
+    if (policy.Mode == TZWAVEChannel::ReportMode::SLOPE) {
+        policy.ModeThreshold *= multiplier;
+    }
+    channel.SetReportPolicy(policy);
+    if (channel.GetType() == TZWAVEChannel::Type::NOISE_LEVEL) {
+        uint32_t soundLevelWindowMs =
+            (uint32_t)GetParameterValue(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_LEQ_WINDOW) * 1000;
+        if (soundLevelWindowMs != SoundLevelWindowMs) {
+            SoundLevelWindowMs = soundLevelWindowMs;
+            SoundLevelTime = millis();
+            NoiseExtremesTime = SoundLevelTime;
+            NoiseExtremes.Reset();
+        }
+    }
+    channel.SetFilter(GetChannelParameterValue(GetAnalogChannelParameterNumber(
+                          channel.GetType(),
+                          WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MEDIAN_FILTER_SIZE)),
+                      (uint32_t)GetChannelParameterValue(GetAnalogChannelParameterNumber(
+                          channel.GetType(),
+                          WB_MSW_CONFIG_PARAMETER_TEMPERATURE_SMOOTHING_TIME)) *
+                          1000);
+    Reports.SetChannelRate(channel.GetServerChannelNumber(),
+                           GetChannelParameterValue(GetAnalogChannelParameterNumber(
+                               channel.GetType(),
+                               WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORTS_RATE_LIMIT)),
+                           WB_MSW_CHANNEL_REPORTS_BURST);
+}
+
+// Applies parameters which don't belong to any channel
+void TZWAVESensor::UpdateDeviceSettings()
+{
+    Reports.SetRate(GetParameterValue(WB_MSW_CONFIG_PARAMETER_REPORTS_RATE_LIMIT), WB_MSW_REPORTS_BURST);
+    uint32_t statisticsWindowMs =
+        (uint32_t)GetParameterValue(WB_MSW_CONFIG_PARAMETER_STATISTICS_WINDOW) * WB_MSW_STATISTICS_WINDOW_UNIT_MS;
+    if (statisticsWindowMs != StatisticsWindowMs) {
+        StatisticsWindowMs = statisticsWindowMs;
+        StatisticsTime = millis();
+        // The values collected so far belong to a window of the old length
+        for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+            Channels[i].GetStatistics().Reset();
+        }
+    }
+    // The statistics channel may have changed
+    PublishStatistics();
+}
+
+// Starts the next window after the expired one. After a stall (modbus errors, firmware update)
+// the windows missed meanwhile are skipped, and the next one starts now
+static void StartNextWindow(uint32_t& windowTime, uint32_t windowMs)
+{
+    uint32_t currentTime = millis();
+    if (currentTime - windowTime >= 2 * windowMs) {
+        windowTime = currentTime;
+    } else {
+        windowTime += windowMs;
+    }
+}
+
+// Closes the statistics window of all channels when it expires
+void TZWAVESensor::ProcessStatistics()
+{
+    if (StatisticsWindowMs == 0 || millis() - StatisticsTime < StatisticsWindowMs) {
+        return;
+    }
+    StartNextWindow(StatisticsTime, StatisticsWindowMs);
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        Channels[i].GetStatistics().Finish();
+    }
+    PublishStatistics();
+}
+
+// Writes the last window of the selected channel to the read-only parameters.
+// The parameters are kept in flash, so they are written only when changed, and windows are 15 minutes at least
+void TZWAVESensor::PublishStatistics()
+{
+    size_t type = GetParameterValue(WB_MSW_CONFIG_PARAMETER_STATISTICS_CHANNEL);
+    if (type > static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL)) {
+        return;
+    }
+    const TWindowStatistics::Result& result = ChannelsByType[type]->GetStatistics().GetLast();
+    // Values of another channel or window must not be shown as the ones of this window
+    if (result.Count == 0) {
+        SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_STATISTICS_MINIMUM, WB_MSW_STATISTICS_NO_VALUE);
+        SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_STATISTICS_MAXIMUM, WB_MSW_STATISTICS_NO_VALUE);
+        SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_STATISTICS_MEAN, WB_MSW_STATISTICS_NO_VALUE);
+        return;
+    }
+    SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_STATISTICS_MINIMUM, result.Min);
+    SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_STATISTICS_MAXIMUM, result.Max);
+    SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_STATISTICS_MEAN, result.Mean);
+}
+
+void TZWAVESensor::SaveReadOnlyParameter(uint8_t paramNumber, int32_t value)
+{
+    if (ParameterValues[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST] == value) {
+        return;
+    }
+    ParameterValues[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST] = value;
+    zunoSaveCFGParam(paramNumber, value);
+}
+
+const ZunoCFGParameter_t* TZWAVESensor::GetParameterByNumber(size_t paramNumber)
 {
     // DEBUG("Get parameter ");
     // DEBUG(paramNumber);
     // DEBUG("\n");
-    if (paramNumber < WB_MSW_CONFIG_PARAMETER_FIRST || paramNumber > WB_MSW_CONFIG_PARAMETER_LAST) {
+    if (paramNumber < WB_MSW_CONFIG_PARAMETER_FIRST || paramNumber >= WB_MSW_CONFIG_PARAMETER_LAST) {
         DEBUG("***ERROR Wrong parameter number \n");
         return NULL;
     }
-    return &Parameters[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST];
+    return &Parameters[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST].Description;
 }
 
 // Finds channel of needed type
 TZWAVEChannel* TZWAVESensor::GetChannelByType(TZWAVEChannel::Type type)
 {
-    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
-        if (Channels[i].GetType() == type) {
-            return (&Channels[i]);
-        }
-    }
-    return NULL;
+    return ChannelsByType[static_cast<size_t>(type)];
 }
 
 // Returns parameter's description if corresponding channel exists
 const ZunoCFGParameter_t* TZWAVESensor::GetParameterIfChannelExists(size_t paramNumber)
 {
-    switch (paramNumber) {
-        case WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORT_THRESHOLD:
-        case WB_MSW_CONFIG_PARAMETER_TEMPERATURE_LEVEL_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_TEMPERATURE_HYSTERESIS_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_TEMPERATURE_ON_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_TEMPERATURE_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_TEMPERATURE_ON_OFF_COMMANDS_RULE:
-            if (!GetChannelByType(TZWAVEChannel::Type::TEMPERATURE)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            }
-            break;
-        case WB_MSW_CONFIG_PARAMETER_HUMIDITY_REPORT_THRESHOLD:
-        case WB_MSW_CONFIG_PARAMETER_HUMIDITY_LEVEL_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_HUMIDITY_HYSTERESIS_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_HUMIDITY_ON_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_HUMIDITY_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_HUMIDITY_ON_OFF_COMMANDS_RULE:
-            if (!GetChannelByType(TZWAVEChannel::Type ::HUMIDITY)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            }
-            break;
-        case WB_MSW_CONFIG_PARAMETER_LUMEN_REPORT_THRESHOLD:
-        case WB_MSW_CONFIG_PARAMETER_LUMEN_LEVEL_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_LUMEN_HYSTERESIS_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_LUMEN_ON_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_LUMEN_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_LUMEN_ON_OFF_COMMANDS_RULE:
-            if (!GetChannelByType(TZWAVEChannel::Type::LUMEN)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            }
-            break;
-        case WB_MSW_CONFIG_PARAMETER_CO2_REPORT_THRESHOLD:
-        case WB_MSW_CONFIG_PARAMETER_CO2_LEVEL_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_CO2_HYSTERESIS_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_CO2_ON_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_CO2_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_CO2_ON_OFF_COMMANDS_RULE:
-            if (!GetChannelByType(TZWAVEChannel::Type::CO2)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            }
-            break;
-        case WB_MSW_CONFIG_PARAMETER_VOC_REPORT_THRESHOLD:
-        case WB_MSW_CONFIG_PARAMETER_VOC_LEVEL_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_VOC_HYSTERESIS_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_VOC_ON_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_VOC_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_VOC_ON_OFF_COMMANDS_RULE:
-            if (!GetChannelByType(TZWAVEChannel::Type::VOC)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            }
-            break;
-        case WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_REPORT_THRESHOLD:
-        case WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_LEVEL_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_HYSTERESIS_SEND_BASIC:
-        case WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_ON_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_ON_OFF_COMMANDS_RULE:
-            if (!GetChannelByType(TZWAVEChannel::Type::NOISE_LEVEL)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            }
-            break;
-        case WB_MSW_CONFIG_PARAMETER_MOTION_DELAY_SEND_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_MOTION_ON_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_MOTION_OFF_COMMANDS:
-        case WB_MSW_CONFIG_PARAMETER_MOTION_ON_OFF_COMMANDS_RULE:
-            if (!GetChannelByType(TZWAVEChannel::Type::MOTION)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            }
-            break;
-        case WB_MSW_CONFIG_PARAMETER_INTRUSION_REPORT_THRESHOLD:
-        case WB_MSW_CONFIG_PARAMETER_INTRUSION_DELAY_SEND_OFF_COMMANDS:
-            if (!GetChannelByType(TZWAVEChannel::Type::INTRUSION)) {
-                return (ZUNO_CFG_PARAMETER_UNKNOWN);
+    if (paramNumber < WB_MSW_CONFIG_PARAMETER_FIRST || paramNumber >= WB_MSW_CONFIG_PARAMETER_LAST) {
+        return (ZUNO_CFG_PARAMETER_UNKNOWN);
+    }
+    const TZWAVEParameter& parameter = Parameters[paramNumber - WB_MSW_CONFIG_PARAMETER_FIRST];
+    if (parameter.ChannelType == DeviceWideParameterType) {
+        return &parameter.Description;
+    }
+    TZWAVEChannel* channel = GetChannelByType(parameter.ChannelType);
+    if (!channel || !channel->HasEndpoint()) {
+        return (ZUNO_CFG_PARAMETER_UNKNOWN);
+    }
+    return &parameter.Description;
+}
+
+// Applies the channel report mode to a new value of an initialized channel
+bool TZWAVESensor::IsReportNeeded(TZWAVEChannel& channel, int64_t value)
+{
+    const TZWAVEChannel::ReportPolicy& policy = channel.GetReportPolicy();
+    int64_t reportedValue = channel.GetReportedValue();
+    int64_t change = abs(value - reportedValue);
+
+    switch (policy.Mode) {
+        case TZWAVEChannel::ReportMode::RELATIVE:
+            return change * 100 > abs(reportedValue) * policy.ModeThreshold;
+        case TZWAVEChannel::ReportMode::SLOPE:
+            // The slope is tracked on every value, so that it is ready when the change starts
+            if (abs(channel.UpdateSlope(value)) > policy.ModeThreshold && change != 0) {
+                return true;
             }
-            break;
+            return change > policy.ReportThresHold;
         default:
-            return (ZUNO_CFG_PARAMETER_UNKNOWN);
-            break;
+            return change > policy.ReportThresHold;
     }
-    return GetParameterByNumber(paramNumber);
 }
 
-void TZWAVESensor::PublishAnalogSensorValue(TZWAVEChannel& channel,
-                                            int64_t value,
-                                            int32_t reportThresHold,
-                                            int32_t levelSendBasic,
-                                            int32_t hysteresisBasic,
-                                            int32_t onCommands,
-                                            int32_t offCommands,
-                                            int32_t onOffCommandsRule)
+void TZWAVESensor::PublishAnalogSensorValue(TZWAVEChannel& channel, int64_t value)
 {
-    uint16_t multiplier;
+    const TZWAVEChannel::ReportPolicy& policy = channel.GetReportPolicy();
     uint8_t groupIndex;
-    bool triggered;
 
-    multiplier = channel.GetMultiplier();
-    reportThresHold = reportThresHold * multiplier;
     // Send value without condition if channels value uninitialized on server
-    if ((reportThresHold != 0) && ((channel.GetState() == TZWAVEChannel::State::UNINITIALIZED) ||
-                                   (abs(value - channel.GetReportedValue()) > reportThresHold)))
+    if ((policy.ReportThresHold != 0) &&
+        ((channel.GetState() == TZWAVEChannel::State::UNINITIALIZED) || IsReportNeeded(channel, value)))
     {
         // DEBUG("Channel ");
         // DEBUG(channel.GetType());
@@ -708,24 +1411,21 @@ void TZWAVESensor::PublishAnalogSensorValue(TZWAVEChannel& channel,
         // DEBUG(value);
         // DEBUG("\n");
         channel.SetReportedValue(value); // Remember last sent value
-        zunoSendReport(channel.GetServerChannelNumber());
+        Reports.AddReport(channel.GetServerChannelNumber(), TReportQueue::Priority::ANALOG);
     }
-    levelSendBasic = levelSendBasic * multiplier;
-    hysteresisBasic = hysteresisBasic * multiplier;
     groupIndex = channel.GetGroupIndex();
-    triggered = channel.GetTriggered();
-    if (triggered) {
-        if (value <= (levelSendBasic - hysteresisBasic)) {
+    if (channel.GetTriggered()) {
+        if (value <= policy.LevelOff) {
             channel.SetTriggered(false);
-            if (onOffCommandsRule == 1 || onOffCommandsRule == 3) {
-                zunoSendToGroupSetValueCommand(groupIndex, offCommands);
+            if (policy.SendOffCommand) {
+                Reports.AddBasicSet(groupIndex, policy.OffCommand);
             }
         }
     } else {
-        if (value >= (levelSendBasic + hysteresisBasic)) {
+        if (value >= policy.LevelOn) {
             channel.SetTriggered(true);
-            if (onOffCommandsRule == 1 || onOffCommandsRule == 2) {
-                zunoSendToGroupSetValueCommand(groupIndex, onCommands);
+            if (policy.SendOnCommand) {
+                Reports.AddBasicSet(groupIndex, policy.OnCommand);
             }
         }
     }
@@ -733,56 +1433,49 @@ void TZWAVESensor::PublishAnalogSensorValue(TZWAVEChannel& channel,
 
 void TZWAVESensor::PublishIntrusionValue(TZWAVEChannel* channel, int64_t value)
 {
-    uint32_t intrusionPeriod;
-    int64_t reportThresHold;
+    const TZWAVEChannel::ReportPolicy& policy = channel->GetReportPolicy();
     uint32_t currentTime;
 
-    reportThresHold = GetParameterValue(channel->GetReportThresHoldParameterNumber()) * channel->GetMultiplier();
     if (channel->GetState() == TZWAVEChannel::State::UNINITIALIZED) {
         channel->SetTriggered(false);
         channel->SetValue(false);
         channel->SetReportedValue(false); // Remember last sent value
-        zunoSendReport(channel->GetServerChannelNumber());
+        Reports.AddReport(channel->GetServerChannelNumber(), TReportQueue::Priority::EVENT);
     }
     currentTime = millis();
     if (channel->GetTriggered()) {
-        if (value < (reportThresHold)) {
+        if (value < policy.ReportThresHold) {
             channel->SetTriggered(false);
             IntrusionLastTime = currentTime;
             IntrusionLastTimeWaitOff = true;
         }
     } else {
-        if (value > (reportThresHold)) {
+        if (value > policy.ReportThresHold) {
             channel->SetTriggered(true);
             if (!channel->GetReportedValue()) {
                 channel->SetValue(true);
                 channel->SetReportedValue(true); // Remember last sent value
-                zunoSendReport(channel->GetServerChannelNumber());
+                Reports.AddReport(channel->GetServerChannelNumber(), TReportQueue::Priority::EVENT);
                 IntrusionLastTimeWaitOff = false;
             }
         }
     }
     if (IntrusionLastTimeWaitOff) {
-        intrusionPeriod = (uint32_t)GetParameterValue(WB_MSW_CONFIG_PARAMETER_INTRUSION_DELAY_SEND_OFF_COMMANDS) * 1000;
-        if ((IntrusionLastTime + intrusionPeriod) <= currentTime) {
+        if ((IntrusionLastTime + policy.OffDelayMs) <= currentTime) {
             IntrusionLastTimeWaitOff = false;
             channel->SetValue(false);
             channel->SetReportedValue(false); // Remember last sent value
-            zunoSendReport(channel->GetServerChannelNumber());
+            Reports.AddReport(channel->GetServerChannelNumber(), TReportQueue::Priority::EVENT);
         }
     }
 }
 
 void TZWAVESensor::PublishMotionValue(TZWAVEChannel* channel, int64_t value)
 {
-    int32_t onCommands;
-    int32_t offCommands;
-    int32_t onOffCommandsRule;
+    const TZWAVEChannel::ReportPolicy& policy = channel->GetReportPolicy();
     uint8_t groupIndex;
-    uint32_t motionPeriod;
     uint32_t currentTime;
 
-    onOffCommandsRule = GetParameterValue(channel->GetOnOffCommandsRuleParameterNumber());
     groupIndex = channel->GetGroupIndex();
     currentTime = millis();
     if (channel->GetTriggered()) {
@@ -797,25 +1490,22 @@ void TZWAVESensor::PublishMotionValue(TZWAVEChannel* channel, int64_t value)
             if (!channel->GetReportedValue()) {
                 channel->SetValue(true);
                 channel->SetReportedValue(true); // Remember last sent value
-                zunoSendReport(channel->GetServerChannelNumber());
+                Reports.AddReport(channel->GetServerChannelNumber(), TReportQueue::Priority::EVENT);
                 MotionLastTimeWaitOff = false;
-                if (onOffCommandsRule == 1 || onOffCommandsRule == 2) {
-                    onCommands = GetParameterValue(channel->GetOnCommandsParameterNumber());
-                    zunoSendToGroupSetValueCommand(groupIndex, onCommands);
+                if (policy.SendOnCommand) {
+                    Reports.AddBasicSet(groupIndex, policy.OnCommand);
                 }
             }
         }
     }
     if (MotionLastTimeWaitOff) {
-        motionPeriod = (uint32_t)GetParameterValue(WB_MSW_CONFIG_PARAMETER_MOTION_DELAY_SEND_OFF_COMMANDS) * 1000;
-        if ((MotionLastTime + motionPeriod) <= currentTime) {
+        if ((MotionLastTime + policy.OffDelayMs) <= currentTime) {
             MotionLastTimeWaitOff = false;
             channel->SetValue(false);
             channel->SetReportedValue(false); // Remember last sent value
-            zunoSendReport(channel->GetServerChannelNumber());
-            if (onOffCommandsRule == 1 || onOffCommandsRule == 3) {
-                offCommands = GetParameterValue(channel->GetOffCommandsParameterNumber());
-                zunoSendToGroupSetValueCommand(groupIndex, offCommands);
+            Reports.AddReport(channel->GetServerChannelNumber(), TReportQueue::Priority::EVENT);
+            if (policy.SendOffCommand) {
+                Reports.AddBasicSet(groupIndex, policy.OffCommand);
             }
         }
     }
@@ -825,12 +1515,6 @@ void TZWAVESensor::PublishMotionValue(TZWAVEChannel* channel, int64_t value)
 TZWAVESensor::Result TZWAVESensor::ProcessCommonChannel(TZWAVEChannel& channel)
 {
     int64_t currentValue;
-    int32_t reportThresHold;
-    int32_t levelSendBasic;
-    int32_t hysteresisBasic;
-    int32_t onCommands;
-    int32_t offCommands;
-    int32_t onOffCommandsRule;
 
     if (channel.GetType() == TZWAVEChannel::Type::CO2) {
         // Check if automatic calibration is needed
@@ -846,26 +1530,119 @@ TZWAVESensor::Result TZWAVESensor::ProcessCommonChannel(TZWAVEChannel& channel)
         if (currentValue == channel.GetErrorValue()) {
             return TZWAVESensor::Result::ZWAVE_PROCESS_VALUE_ERROR;
         }
-    } else {
+    } else if (IntrusionChannelPtr && IntrusionChannelPtr->GetEnabled()) {
+        // Intrusion reacts to sudden noise, so it takes the raw value
         PublishIntrusionValue(IntrusionChannelPtr, currentValue);
     }
+    UpdateAnalogValue(channel, currentValue);
+    return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+}
+
+void TZWAVESensor::UpdateAnalogValue(TZWAVEChannel& channel, int64_t value)
+{
     DEBUG(channel.GetName());
-    LOG_FIXEDPOINT_VALUE("        ", currentValue, 2);
-    channel.SetValue(currentValue);
-    reportThresHold = GetParameterValue(channel.GetReportThresHoldParameterNumber());
-    levelSendBasic = GetParameterValue(channel.GetLevelSendBasicParameterNumber());
-    hysteresisBasic = GetParameterValue(channel.GetHysteresisBasicParameterNumber());
-    onCommands = GetParameterValue(channel.GetOnCommandsParameterNumber());
-    offCommands = GetParameterValue(channel.GetOffCommandsParameterNumber());
-    onOffCommandsRule = GetParameterValue(channel.GetOnOffCommandsRuleParameterNumber());
-    PublishAnalogSensorValue(channel,
-                             currentValue,
-                             reportThresHold,
-                             levelSendBasic,
-                             hysteresisBasic,
-                             onCommands,
-                             offCommands,
-                             onOffCommandsRule);
+    LOG_FIXEDPOINT_VALUE("        ", value, 2);
+    value = channel.FilterValue(value);
+    channel.SetValue(value);
+    channel.GetStatistics().Add(value);
+    PublishAnalogSensorValue(channel, value);
+}
+
+// Fast lane: the event sources are sampled between the reads of the other channels,
+// so the detection sees the short peaks a single read per poll cycle misses
+TZWAVESensor::Result TZWAVESensor::ProcessFastSampling()
+{
+    TZWAVESensor::Result result = ProcessNoiseSampling();
+    if (result != TZWAVESensor::Result::ZWAVE_PROCESS_OK) {
+        return result;
+    }
+    return ProcessMotionSampling();
+}
+
+// Noise samples go to the Leq window and the intrusion detection. Without the window the noise is read
+// once per poll cycle only, and the intrusion detection takes that value (see ProcessCommonChannel)
+TZWAVESensor::Result TZWAVESensor::ProcessNoiseSampling()
+{
+    TZWAVEChannel* channel = ChannelsByType[static_cast<size_t>(TZWAVEChannel::Type::NOISE_LEVEL)];
+    if (SoundLevelWindowMs == 0 || !channel->GetEnabled() ||
+        millis() - NoiseSampleTime < WB_MSW_NOISE_SAMPLE_PERIOD_MS)
+    {
+        return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+    }
+    int64_t value;
+    if (!channel->ReadValueFromSensor(value)) {
+        return TZWAVESensor::Result::ZWAVE_PROCESS_MODBUS_ERROR;
+    }
+    NoiseSampleTime = millis();
+    if (IntrusionChannelPtr && IntrusionChannelPtr->GetEnabled()) {
+        PublishIntrusionValue(IntrusionChannelPtr, value);
+    }
+    SoundLevel.Add(value);
+    return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+}
+
+// Local peak hold of the motion, used only if the sensor doesn't keep the maximum itself
+TZWAVESensor::Result TZWAVESensor::ProcessMotionSampling()
+{
+    if (!MotionChannelPtr || !MotionChannelPtr->GetEnabled() ||
+        WbMsw->GetMotionMaxAvailability() != TWBMSWSensor::Availability::UNAVAILABLE ||
+        millis() - MotionSampleTime < WB_MSW_MOTION_SAMPLE_PERIOD_MS)
+    {
+        return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+    }
+    int64_t value;
+    if (!MotionChannelPtr->ReadValueFromSensor(value)) {
+        return TZWAVESensor::Result::ZWAVE_PROCESS_MODBUS_ERROR;
+    }
+    MotionSampleTime = millis();
+    if (value != WB_MSW_INPUT_REG_MOTION_VALUE_ERROR && (!MotionPeakValid || value > MotionPeak)) {
+        MotionPeak = value;
+        MotionPeakValid = true;
+    }
+    return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+}
+
+// Maximum motion since the previous poll of the channel, so the events don't depend on the poll period
+bool TZWAVESensor::ReadMotionPeak(TZWAVEChannel& channel, int64_t& value)
+{
+    if (WbMsw->GetMotionMax(value)) {
+        return true;
+    }
+    if (WbMsw->GetMotionMaxAvailability() != TWBMSWSensor::Availability::UNAVAILABLE ||
+        !channel.ReadValueFromSensor(value))
+    {
+        return false;
+    }
+    if (MotionPeakValid && value != WB_MSW_INPUT_REG_MOTION_VALUE_ERROR && MotionPeak > value) {
+        value = MotionPeak;
+    }
+    MotionPeakValid = false;
+    return true;
+}
+
+// Reports the Leq of the window when it expires. Lmax and Lmin go to the read-only parameters, they are kept
+// in flash, so short windows are merged until WB_MSW_NOISE_EXTREMES_WINDOW_MS passes
+TZWAVESensor::Result TZWAVESensor::ProcessSoundLevelChannel(TZWAVEChannel& channel)
+{
+    TZWAVESensor::Result result = ProcessNoiseSampling();
+    if (result != TZWAVESensor::Result::ZWAVE_PROCESS_OK || millis() - SoundLevelTime < SoundLevelWindowMs) {
+        return result;
+    }
+    StartNextWindow(SoundLevelTime, SoundLevelWindowMs);
+    SoundLevel.Finish();
+    const TSoundLevel::Result& level = SoundLevel.GetLast();
+    if (level.Count == 0) {
+        return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+    }
+    NoiseExtremes.Add(level.Max);
+    NoiseExtremes.Add(level.Min);
+    if (millis() - NoiseExtremesTime >= WB_MSW_NOISE_EXTREMES_WINDOW_MS) {
+        NoiseExtremesTime = millis();
+        NoiseExtremes.Finish();
+        SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MAXIMUM, NoiseExtremes.GetLast().Max);
+        SaveReadOnlyParameter(WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MINIMUM, NoiseExtremes.GetLast().Min);
+    }
+    UpdateAnalogValue(channel, level.Leq);
     return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
 }
 
@@ -873,7 +1650,7 @@ TZWAVESensor::Result TZWAVESensor::ProcessMotionChannel(TZWAVEChannel& channel)
 {
     int64_t value;
 
-    if (!channel.ReadValueFromSensor(value)) {
+    if (!ReadMotionPeak(channel, value)) {
         return TZWAVESensor::Result::ZWAVE_PROCESS_MODBUS_ERROR;
     }
     if (value == WB_MSW_INPUT_REG_MOTION_VALUE_ERROR) {
@@ -890,7 +1667,7 @@ TZWAVESensor::Result TZWAVESensor::ProcessMotionChannel(TZWAVEChannel& channel)
         channel.SetTriggered(false);
         channel.SetValue(false);
         channel.SetReportedValue(false); // Remember last sent value
-        zunoSendReport(channel.GetServerChannelNumber());
+        Reports.AddReport(channel.GetServerChannelNumber(), TReportQueue::Priority::EVENT);
     }
     PublishMotionValue(&channel, value);
     return (TZWAVESensor::Result::ZWAVE_PROCESS_OK);
@@ -898,36 +1675,316 @@ TZWAVESensor::Result TZWAVESensor::ProcessMotionChannel(TZWAVEChannel& channel)
 
 void TZWAVESensor::MotionChannelReset(TZWAVEChannel* channel)
 {
-    if (channel) {
+    if (channel && channel->GetEnabled()) {
         PublishMotionValue(channel, false);
     }
 }
 
+// Reads the channel from the sensor and reports its value if needed
+TZWAVESensor::Result TZWAVESensor::ProcessChannel(TZWAVEChannel& channel)
+{
+    if (!channel.GetEnabled()) {
+        return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+    }
+    switch (channel.GetType()) {
+        case TZWAVEChannel::Type::INTRUSION:
+        case TZWAVEChannel::Type::BUZZER:
+        case TZWAVEChannel::Type::DEW_POINT:
+        case TZWAVEChannel::Type::ABSOLUTE_HUMIDITY:
+        case TZWAVEChannel::Type::AIR_QUALITY:
+            return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+        case TZWAVEChannel::Type::MOTION:
+            return ProcessMotionChannel(channel);
+        case TZWAVEChannel::Type::NOISE_LEVEL:
+            if (SoundLevelWindowMs) {
+                return ProcessSoundLevelChannel(channel);
+            }
+            return ProcessCommonChannel(channel);
+        default:
+            return ProcessCommonChannel(channel);
+    }
+}
+
+// Reads the channels requested by the controller ahead of the rest of the poll cycle.
+// The controller got the old value in answer to its Get, so the new one is reported if it differs
+TZWAVESensor::Result TZWAVESensor::ProcessFreshValueRequests(uint32_t& processedChannels)
+{
+    uint32_t requests = __atomic_exchange_n(&FreshValueRequests, 0, __ATOMIC_ACQ_REL);
+    for (size_t i = 0; requests && i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        if (requests & (1UL << i)) {
+            TZWAVEChannel& channel = Channels[i];
+            uint32_t time;
+            uint32_t newTime;
+            processedChannels |= 1UL << i;
+            int32_t oldValue = channel.GetValue(time);
+            if (ProcessChannel(channel) == TZWAVESensor::Result::ZWAVE_PROCESS_MODBUS_ERROR) {
+                return TZWAVESensor::Result::ZWAVE_PROCESS_MODBUS_ERROR;
+            }
+            int32_t value = channel.GetValue(newTime);
+            if (newTime != time && value != oldValue) {
+                channel.SetReportedValue(value);
+                Reports.AddReport(channel.GetServerChannelNumber(), TReportQueue::Priority::ANALOG);
+            }
+        }
+    }
+    return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+}
+
 // Device channel management and firmware data transfer
 TZWAVESensor::Result TZWAVESensor::ProcessChannels()
 {
     DEBUG("--------------------Measurements-----------------------\n");
     // Check all channels of available sensors
     TZWAVESensor::Result result;
+    uint32_t processedChannels = 0;
+    UpdateParameterValues();
+    UpdateChannelsAvailability();
     for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
-        if (Channels[i].GetEnabled()) {
-            switch (Channels[i].GetType()) {
-                case TZWAVEChannel::Type::INTRUSION:
-                case TZWAVEChannel::Type::BUZZER:
-                    result = TZWAVESensor::Result::ZWAVE_PROCESS_OK;
-                    break;
-                case TZWAVEChannel::Type::MOTION:
-                    result = ProcessMotionChannel(Channels[i]);
-                    break;
-                default:
-                    result = ProcessCommonChannel(Channels[i]);
-                    break;
-            }
+        result = ProcessFreshValueRequests(processedChannels);
+        if (result == TZWAVESensor::Result::ZWAVE_PROCESS_OK) {
+            result = ProcessFastSampling();
+        }
+        if (result == TZWAVESensor::Result::ZWAVE_PROCESS_OK && !(processedChannels & (1UL << i))) {
+            processedChannels |= 1UL << i;
+            result = ProcessChannel(Channels[i]);
         }
+        // Don't keep events waiting for the rest of the cycle
+        Reports.Process();
         if (result == TZWAVESensor::Result::ZWAVE_PROCESS_MODBUS_ERROR) {
             MotionChannelReset(MotionChannelPtr);
+            SaveState();
             return result;
         }
     }
+    ProcessDerivedChannels();
+    ProcessPeriodicReports();
+    ProcessStatistics();
+    SaveState();
     return TZWAVESensor::Result::ZWAVE_PROCESS_OK;
+}
+
+// Computes the channels derived from new values of their source channels
+void TZWAVESensor::ProcessDerivedChannels()
+{
+    for (size_t i = 0; i < sizeof(DerivedChannels) / sizeof(DerivedChannels[0]); i++) {
+        const TZWAVEDerivedChannel& derived = DerivedChannels[i];
+        TZWAVEChannel& channel = *ChannelsByType[static_cast<size_t>(derived.ChannelType)];
+        const TZWAVEChannel& first = *ChannelsByType[static_cast<size_t>(derived.Sources[0])];
+        const TZWAVEChannel& second = *ChannelsByType[static_cast<size_t>(derived.Sources[1])];
+        if (!channel.GetEnabled() || !first.GetEnabled() || !second.GetEnabled()) {
+            continue;
+        }
+        uint32_t time;
+        uint32_t firstTime;
+        uint32_t secondTime;
+        channel.GetValue(time);
+        int32_t firstValue = first.GetValue(firstTime);
+        int32_t secondValue = second.GetValue(secondTime);
+        if (firstTime == 0 || secondTime == 0 ||
+            ((int32_t)(firstTime - time) <= 0 && (int32_t)(secondTime - time) <= 0))
+        {
+            continue;
+        }
+        int32_t value = derived.Compute(firstValue, secondValue);
+        DEBUG(channel.GetName());
+        LOG_FIXEDPOINT_VALUE("  ", value, 2);
+        channel.SetValue(value);
+        PublishAnalogSensorValue(channel, value);
+    }
+}
+
+// Reports again the values not reported for their maximum interval.
+// Once any channel is due, the channels due soon are reported too, so that periodic reports go in one burst
+void TZWAVESensor::ProcessPeriodicReports()
+{
+    uint32_t currentTime = millis();
+    uint32_t timeLeft[TZWAVEChannel::CHANNEL_TYPES_COUNT];
+    bool due = false;
+
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        const TZWAVEChannel& channel = Channels[i];
+        uint32_t interval = channel.GetReportPolicy().MaxReportIntervalMs;
+        timeLeft[i] = UINT32_MAX;
+        if (interval == 0 || !channel.GetEnabled() || channel.GetState() == TZWAVEChannel::State::UNINITIALIZED) {
+            continue;
+        }
+        uint32_t elapsed = currentTime - channel.GetReportTime();
+        if (elapsed >= interval) {
+            timeLeft[i] = 0;
+            due = true;
+        } else {
+            timeLeft[i] = interval - elapsed;
+        }
+    }
+    if (!due) {
+        return;
+    }
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        TZWAVEChannel& channel = Channels[i];
+        if (timeLeft[i] > channel.GetReportPolicy().MaxReportIntervalMs / WB_MSW_HEARTBEAT_ALIGN_DIVIDER) {
+            continue;
+        }
+        channel.SetReportedValue(channel.GetValue());
+        Reports.AddReport(channel.GetServerChannelNumber(), TReportQueue::Priority::ANALOG);
+    }
+}
+
+bool TZWAVESensor::EnableChannel(TZWAVEChannel& channel)
+{
+    if ((channel.GetType() == TZWAVEChannel::Type::CO2) &&
+        (!channel.SetPowerOn() || !channel.SetAutocalibration(WB_MSW_CONFIG_PARAMETER_CO2_AUTO_VALUE)))
+    {
+        return false;
+    }
+    if (channel.GetType() == TZWAVEChannel::Type::MOTION) {
+        MotionChannelPtr = &channel;
+        MotionPeakValid = false;
+    }
+    if (channel.GetType() == TZWAVEChannel::Type::INTRUSION) {
+        IntrusionChannelPtr = &channel;
+    }
+    DEBUG(channel.GetName());
+    DEBUG(" CHANNEL AVAILABLE\n");
+    channel.ResetState();
+    channel.Enable();
+    return true;
+}
+
+void TZWAVESensor::DisableChannel(TZWAVEChannel& channel)
+{
+    if (channel.GetType() == TZWAVEChannel::Type::MOTION) {
+        MotionChannelReset(&channel);
+    }
+    DEBUG(channel.GetName());
+    DEBUG(" CHANNEL UNAVAILABLE\n");
+    channel.Disable();
+    channel.ResetState();
+    // The getter returns the error value for disabled channels
+    Reports.AddReport(channel.GetServerChannelNumber(), TReportQueue::Priority::ANALOG);
+}
+
+// Sensors connected or disconnected at runtime are found by a periodic check of all availability registers
+// made in one modbus transaction. Only channels with endpoints are checked, as others can't be reported
+void TZWAVESensor::UpdateChannelsAvailability()
+{
+    if (millis() - AvailabilityCheckTime < WB_MSW_INPUT_REG_AVAILABILITY_PERIOD_MS) {
+        return;
+    }
+    AvailabilityCheckTime = millis();
+    if (!WbMsw->ReadAvailabilityBlock()) {
+        return;
+    }
+    for (size_t i = 0; i < TZWAVEChannel::CHANNEL_TYPES_COUNT; i++) {
+        if (!Channels[i].HasEndpoint() || !Channels[i].UpdateAvailability()) {
+            continue;
+        }
+        TWBMSWSensor::Availability availability = Channels[i].GetAvailability();
+        if (Channels[i].GetEnabled() && availability == TWBMSWSensor::Availability::UNAVAILABLE) {
+            DisableChannel(Channels[i]);
+        } else if (!Channels[i].GetEnabled() && availability == TWBMSWSensor::Availability::AVAILABLE) {
+            // The sensor doesn't respond properly, the rest is checked on the next period
+            if (!EnableChannel(Channels[i])) {
+                DEBUG("*** ERROR Can't enable channel ");
+                DEBUG(Channels[i].GetName());
+                DEBUG("\n");
+                break;
+            }
+        }
+    }
+    WbMsw->ReleaseAvailabilityBlock();
+}
+
+// Computed channels are not retained, they are recomputed from the first new values after a reset
+static const size_t RetainedChannelsCount = static_cast<size_t>(TZWAVEChannel::Type::DEW_POINT);
+static_assert(RetainedChannelsCount <= WB_MSW_RETENTION_CHANNELS_FLAGS - WB_MSW_RETENTION_CHANNELS_VALUES,
+              "Not enough retention registers for the channels state");
+
+static uint32_t GetTimeLeft(uint32_t lastTime, uint32_t delayMs, uint32_t currentTime)
+{
+    uint32_t elapsed = currentTime - lastTime;
+    return elapsed < delayMs ? delayMs - elapsed : 0;
+}
+
+static uint16_t GetRetainedStateCrc(const uint32_t* registers)
+{
+    return CrcClass::crc16_modbus(registers, sizeof(uint32_t) * (WB_MSW_RETENTION_CHANNELS_CHECK -
+                                                                   WB_MSW_RETENTION_CHANNELS_VALUES));
+}
+
+// Keeps the reported state in the retention registers, so that it survives Z-Uno resets
+void TZWAVESensor::SaveState(void)
+{
+    uint32_t registers[WB_MSW_RETENTION_CHANNELS_CHECK - WB_MSW_RETENTION_CHANNELS_VALUES] = {};
+    uint32_t& flags = registers[WB_MSW_RETENTION_CHANNELS_FLAGS - WB_MSW_RETENTION_CHANNELS_VALUES];
+    uint32_t currentTime = millis();
+
+    for (size_t i = 0; i < RetainedChannelsCount; i++) {
+        TZWAVEChannel* channel = ChannelsByType[i];
+        if (!channel->GetEnabled() || channel->GetState() == TZWAVEChannel::State::UNINITIALIZED) {
+            continue;
+        }
+        registers[i] = (int32_t)channel->GetReportedValue();
+        flags |= 1UL << i;
+        if (channel->GetTriggered()) {
+            flags |= 1UL << (i + 16);
+        }
+    }
+    if (MotionChannelPtr && MotionLastTimeWaitOff) {
+        flags |= WB_MSW_RETENTION_FLAG_MOTION_WAIT_OFF;
+        registers[WB_MSW_RETENTION_CHANNELS_MOTION_TIMER - WB_MSW_RETENTION_CHANNELS_VALUES] =
+            GetTimeLeft(MotionLastTime, MotionChannelPtr->GetReportPolicy().OffDelayMs, currentTime);
+    }
+    if (IntrusionChannelPtr && IntrusionLastTimeWaitOff) {
+        flags |= WB_MSW_RETENTION_FLAG_INTRUSION_WAIT_OFF;
+        registers[WB_MSW_RETENTION_CHANNELS_INTRUSION_TIMER - WB_MSW_RETENTION_CHANNELS_VALUES] =
+            GetTimeLeft(IntrusionLastTime, IntrusionChannelPtr->GetReportPolicy().OffDelayMs, currentTime);
+    }
+    for (size_t i = 0; i < WB_MSW_RETENTION_CHANNELS_CHECK - WB_MSW_RETENTION_CHANNELS_VALUES; i++) {
+        WbMswRetentionSet(WB_MSW_RETENTION_CHANNELS_VALUES + i, registers[i]);
+    }
+    WbMswRetentionSet(WB_MSW_RETENTION_CHANNELS_CHECK,
+                      (uint32_t)WB_MSW_RETENTION_CHANNELS_MAGIC << 16 | GetRetainedStateCrc(registers));
+}
+
+// Restores the state reported before a warm reset, so that only the values changed meanwhile are reported.
+// Must be called after the channels and parameters initialization
+void TZWAVESensor::RestoreState(void)
+{
+    uint32_t registers[WB_MSW_RETENTION_CHANNELS_CHECK - WB_MSW_RETENTION_CHANNELS_VALUES];
+    for (size_t i = 0; i < WB_MSW_RETENTION_CHANNELS_CHECK - WB_MSW_RETENTION_CHANNELS_VALUES; i++) {
+        registers[i] = WbMswRetentionGet(WB_MSW_RETENTION_CHANNELS_VALUES + i);
+    }
+    // The registers are random after a power loss
+    uint32_t check = WbMswRetentionGet(WB_MSW_RETENTION_CHANNELS_CHECK);
+    if ((check >> 16) != WB_MSW_RETENTION_CHANNELS_MAGIC || (check & 0xFFFF) != GetRetainedStateCrc(registers)) {
+        return;
+    }
+    uint32_t flags = registers[WB_MSW_RETENTION_CHANNELS_FLAGS - WB_MSW_RETENTION_CHANNELS_VALUES];
+    uint32_t currentTime = millis();
+
+    for (size_t i = 0; i < RetainedChannelsCount; i++) {
+        TZWAVEChannel* channel = ChannelsByType[i];
+        if (!channel->GetEnabled() || !(flags & (1UL << i))) {
+            continue;
+        }
+        channel->SetReportedValue((int32_t)registers[i]);
+        channel->SetTriggered(flags & (1UL << (i + 16)));
+        if (channel == MotionChannelPtr || channel == IntrusionChannelPtr) {
+            channel->SetValue((int32_t)registers[i]);
+        }
+    }
+    // Off delays continue from where they were interrupted
+    if (MotionChannelPtr && (flags & WB_MSW_RETENTION_FLAG_MOTION_WAIT_OFF)) {
+        MotionLastTimeWaitOff = true;
+        MotionLastTime = currentTime +
+                         registers[WB_MSW_RETENTION_CHANNELS_MOTION_TIMER - WB_MSW_RETENTION_CHANNELS_VALUES] -
+                         MotionChannelPtr->GetReportPolicy().OffDelayMs;
+    }
+    if (IntrusionChannelPtr && (flags & WB_MSW_RETENTION_FLAG_INTRUSION_WAIT_OFF)) {
+        IntrusionLastTimeWaitOff = true;
+        IntrusionLastTime = currentTime +
+                            registers[WB_MSW_RETENTION_CHANNELS_INTRUSION_TIMER - WB_MSW_RETENTION_CHANNELS_VALUES] -
+                            IntrusionChannelPtr->GetReportPolicy().OffDelayMs;
+    }
+    DEBUG("Channels state restored\n");
 }
\ No newline at end of file
@@ -1,4 +1,8 @@
+#include "TReportQueue.h"
+#include "TSeqLock.h"
+#include "TSoundLevel.h"
 #include "TWBMSWSensor.h"
+#include "TWindowStatistics.h"
 #include "TZWAVEChannel.h"
 #include "WbMsw.h"
 
@@ -12,45 +16,109 @@ public:
         ZWAVE_PROCESS_MODBUS_ERROR
     };
     TZWAVESensor(TWBMSWSensor* wbMsw);
-    bool ChannelsInitialize();
+    bool ChannelsInitialize(bool newLayout);
     void ChannelsSetup();
-    void SetChannelHandlers();
+    void SetChannelHandlers(void* valueGetter);
+    int32_t GetChannelValue(uint8_t channelDeviceNumber);
+    void SetUpdating(bool updating);
     const char* GetGroupNameByIndex(uint8_t groupIndex);
 
     void ParametersInitialize(void);
+    void ResetParameters(void);
+    void RestoreState(void);
     const ZunoCFGParameter_t* GetParameterIfChannelExists(size_t paramNumber);
     void SetParameterValue(size_t paramNumber, int32_t value);
     int32_t GetParameterValue(size_t paramNumber);
 
     TZWAVESensor::Result ProcessChannels();
-    ZunoCFGParameter_t* GetParameterByNumber(size_t paramNumber);
+    void ProcessReports();
+    uint32_t GetDeferredReports() const;
+    const ZunoCFGParameter_t* GetParameterByNumber(size_t paramNumber);
 
 private:
     TWBMSWSensor* WbMsw;
     TZWAVEChannel Channels[TZWAVEChannel::CHANNEL_TYPES_COUNT];
     TZWAVEChannel* MotionChannelPtr;
     TZWAVEChannel* IntrusionChannelPtr;
+    TZWAVEChannel* ChannelsByType[TZWAVEChannel::CHANNEL_TYPES_COUNT];
+    bool Updating; // Sensor firmware update is in progress, read by controller GET handlers
+    TReportQueue Reports;
+    uint32_t DeferredReports; // Last logged number of deferred reports
+    uint32_t DroppedReports;  // Last logged number of reports and commands dropped by the full queue
+    uint32_t StatisticsTime; // Start of the current statistics window
+    uint32_t StatisticsWindowMs;
+    // Noise level sampled between the reads of the other channels, reported as Leq over a window
+    TSoundLevel SoundLevel;
+    uint32_t SoundLevelTime; // Start of the current Leq window
+    uint32_t SoundLevelWindowMs;
+    uint32_t NoiseSampleTime;
+    // Lmax and Lmin of the Leq windows closed within WB_MSW_NOISE_EXTREMES_WINDOW_MS
+    TWindowStatistics NoiseExtremes;
+    uint32_t NoiseExtremesTime;
+    // Peak of the motion samples since the last poll of the channel, if the sensor doesn't keep it
+    int64_t MotionPeak;
+    bool MotionPeakValid;
+    uint32_t MotionSampleTime;
 
-    ZunoCFGParameter_t Parameters[WB_MSW_MAX_CONFIG_PARAM];
+    struct ParameterSet
+    {
+        int32_t Values[WB_MSW_MAX_CONFIG_PARAM];
+        uint32_t Resets; // Number of resets to the defaults after inclusion
+    };
+    // Written by the configuration handler once published, read by the poll loop once per cycle
+    TSeqLock<TZWAVESensor::ParameterSet> SharedParameterValues;
+    // Bit 0 - the values are published, higher bits - flash resets made by the system thread before that
+    uint32_t ParametersState;
+    uint32_t ParameterValuesSequence;
+    uint32_t ParameterResets; // Resets the poll loop has applied
+    // Snapshot the poll loop works with
     int32_t ParameterValues[WB_MSW_MAX_CONFIG_PARAM];
+    void UpdateParameterValues();
+    void UpdateDeviceSettings();
+    void ProcessPeriodicReports();
+    bool IsReportNeeded(TZWAVEChannel& channel, int64_t value);
+    void ProcessStatistics();
+    void ProcessDerivedChannels();
+    void PublishStatistics();
+    void SaveReadOnlyParameter(uint8_t paramNumber, int32_t value);
+
+    struct EndpointsLayout
+    {
+        uint16_t Magic;
+        uint16_t Endpoints; // Bit per channel type
+    };
+    bool LoadEndpointsLayout(uint16_t& endpoints);
+    void SaveEndpointsLayout(uint16_t endpoints);
 
     TZWAVEChannel* GetChannelByType(TZWAVEChannel::Type type);
+    int32_t GetChannelParameterValue(uint8_t paramNumber);
+    void UpdateReportPolicy(TZWAVEChannel& channel);
+
+    // Channels requested by controller GET handlers for reading out of turn, bit per channel
+    uint32_t FreshValueRequests;
+    int32_t GetFreshChannelValue(size_t channelIndex);
+    TZWAVESensor::Result ProcessFreshValueRequests(uint32_t& processedChannels);
 
+    TZWAVESensor::Result ProcessChannel(TZWAVEChannel& channel);
     TZWAVESensor::Result ProcessCommonChannel(TZWAVEChannel& channel);
     TZWAVESensor::Result ProcessMotionChannel(TZWAVEChannel& channel);
+    TZWAVESensor::Result ProcessSoundLevelChannel(TZWAVEChannel& channel);
+    TZWAVESensor::Result ProcessFastSampling();
+    TZWAVESensor::Result ProcessNoiseSampling();
+    TZWAVESensor::Result ProcessMotionSampling();
+    bool ReadMotionPeak(TZWAVEChannel& channel, int64_t& value);
+    void UpdateAnalogValue(TZWAVEChannel& channel, int64_t value);
     void MotionChannelReset(TZWAVEChannel* channel);
+    void UpdateChannelsAvailability();
+    bool EnableChannel(TZWAVEChannel& channel);
+    void DisableChannel(TZWAVEChannel& channel);
+    uint32_t AvailabilityCheckTime;
+    void SaveState(void);
     uint32_t MotionLastTime;
     uint32_t IntrusionLastTime;
     bool MotionLastTimeWaitOff;
     bool IntrusionLastTimeWaitOff;
-    void PublishAnalogSensorValue(TZWAVEChannel& channel,
-                                  int64_t value,
-                                  int32_t reportThresHold,
-                                  int32_t levelSendBasic,
-                                  int32_t hysteresisBasic,
-                                  int32_t onCommands,
-                                  int32_t offCommands,
-                                  int32_t onOffCommandsRule);
+    void PublishAnalogSensorValue(TZWAVEChannel& channel, int64_t value);
     void PublishMotionValue(TZWAVEChannel* channel, int64_t value);
     void PublishIntrusionValue(TZWAVEChannel* channel, int64_t value);
 };
\ No newline at end of file
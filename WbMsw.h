@@ -12,6 +12,11 @@
 #endif
 
 #define WB_MSW_INPUT_REG_AVAILABILITY_TIMEOUT_MS 10000 // ms
+#define WB_MSW_INPUT_REG_AVAILABILITY_PERIOD_MS 60000  // Sensors connection check period
+
+// Endpoints layout kept from the inclusion
+#define WB_MSW_EEPROM_ENDPOINTS_LAYOUT_ADDRESS 0x0000
+#define WB_MSW_EEPROM_ENDPOINTS_LAYOUT_MAGIC 0x4C45 // "EL"
 
 #define WB_MSW_INPUT_REG_TEMPERATURE_VALUE_ERROR 0x7FFF
 #define WB_MSW_INPUT_REG_TEMPERATURE_VALUE_PRECISION SENSOR_MULTILEVEL_PRECISION_TWO_DECIMALS
@@ -38,6 +43,21 @@
 
 #define WB_MSW_INPUT_REG_MOTION_VALUE_ERROR 0xFFFF
 
+// Values computed from other sensors
+#define WB_MSW_DEW_POINT_VALUE_ERROR 0x7FFF
+#define WB_MSW_DEW_POINT_VALUE_PRECISION SENSOR_MULTILEVEL_PRECISION_TWO_DECIMALS
+#define WB_MSW_DEW_POINT_VALUE_SIZE SENSOR_MULTILEVEL_SIZE_TWO_BYTES
+
+#define WB_MSW_ABSOLUTE_HUMIDITY_VALUE_ERROR 0xFFFF
+#define WB_MSW_ABSOLUTE_HUMIDITY_VALUE_PRECISION SENSOR_MULTILEVEL_PRECISION_TWO_DECIMALS
+#define WB_MSW_ABSOLUTE_HUMIDITY_VALUE_SIZE SENSOR_MULTILEVEL_SIZE_TWO_BYTES
+#define WB_MSW_ABSOLUTE_HUMIDITY_SCALE 0x01 // g/m3 scale of the humidity sensor type
+
+#define WB_MSW_AIR_QUALITY_VALUE_ERROR 0xFFFF
+#define WB_MSW_AIR_QUALITY_VALUE_PRECISION SENSOR_MULTILEVEL_PRECISION_ZERO_DECIMALS
+#define WB_MSW_AIR_QUALITY_VALUE_SIZE SENSOR_MULTILEVEL_SIZE_TWO_BYTES
+#define WB_MSW_AIR_QUALITY_SCALE 0x01 // Dimensionless scale of the general purpose sensor type
+
 typedef enum
 {
     WB_MSW_CONFIG_PARAMETER_FIRST = 64,
@@ -100,19 +120,113 @@ typedef enum
     WB_MSW_CONFIG_PARAMETER_INTRUSION_REPORT_THRESHOLD,
     WB_MSW_CONFIG_PARAMETER_INTRUSION_DELAY_SEND_OFF_COMMANDS,
 
+    // Analog channels settings added later are grouped by kind in TZWAVEChannel::Type order
+
+    // Maximum age of values sent on controller requests
+    WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MAX_VALUE_AGE,
+    WB_MSW_CONFIG_PARAMETER_HUMIDITY_MAX_VALUE_AGE,
+    WB_MSW_CONFIG_PARAMETER_LUMEN_MAX_VALUE_AGE,
+    WB_MSW_CONFIG_PARAMETER_CO2_MAX_VALUE_AGE,
+    WB_MSW_CONFIG_PARAMETER_VOC_MAX_VALUE_AGE,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MAX_VALUE_AGE,
+
+    // Reports rate limits
+    WB_MSW_CONFIG_PARAMETER_REPORTS_RATE_LIMIT,
+    WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORTS_RATE_LIMIT,
+    WB_MSW_CONFIG_PARAMETER_HUMIDITY_REPORTS_RATE_LIMIT,
+    WB_MSW_CONFIG_PARAMETER_LUMEN_REPORTS_RATE_LIMIT,
+    WB_MSW_CONFIG_PARAMETER_CO2_REPORTS_RATE_LIMIT,
+    WB_MSW_CONFIG_PARAMETER_VOC_REPORTS_RATE_LIMIT,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_REPORTS_RATE_LIMIT,
+
+    // Periodic reports of unchanged values
+    WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MAX_REPORT_INTERVAL,
+    WB_MSW_CONFIG_PARAMETER_HUMIDITY_MAX_REPORT_INTERVAL,
+    WB_MSW_CONFIG_PARAMETER_LUMEN_MAX_REPORT_INTERVAL,
+    WB_MSW_CONFIG_PARAMETER_CO2_MAX_REPORT_INTERVAL,
+    WB_MSW_CONFIG_PARAMETER_VOC_MAX_REPORT_INTERVAL,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MAX_REPORT_INTERVAL,
+
+    // Filtering of the values read from the sensors
+    WB_MSW_CONFIG_PARAMETER_TEMPERATURE_MEDIAN_FILTER_SIZE,
+    WB_MSW_CONFIG_PARAMETER_HUMIDITY_MEDIAN_FILTER_SIZE,
+    WB_MSW_CONFIG_PARAMETER_LUMEN_MEDIAN_FILTER_SIZE,
+    WB_MSW_CONFIG_PARAMETER_CO2_MEDIAN_FILTER_SIZE,
+    WB_MSW_CONFIG_PARAMETER_VOC_MEDIAN_FILTER_SIZE,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MEDIAN_FILTER_SIZE,
+    WB_MSW_CONFIG_PARAMETER_TEMPERATURE_SMOOTHING_TIME,
+    WB_MSW_CONFIG_PARAMETER_HUMIDITY_SMOOTHING_TIME,
+    WB_MSW_CONFIG_PARAMETER_LUMEN_SMOOTHING_TIME,
+    WB_MSW_CONFIG_PARAMETER_CO2_SMOOTHING_TIME,
+    WB_MSW_CONFIG_PARAMETER_VOC_SMOOTHING_TIME,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_SMOOTHING_TIME,
+
+    // Report rules
+    WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORT_MODE,
+    WB_MSW_CONFIG_PARAMETER_HUMIDITY_REPORT_MODE,
+    WB_MSW_CONFIG_PARAMETER_LUMEN_REPORT_MODE,
+    WB_MSW_CONFIG_PARAMETER_CO2_REPORT_MODE,
+    WB_MSW_CONFIG_PARAMETER_VOC_REPORT_MODE,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_REPORT_MODE,
+    WB_MSW_CONFIG_PARAMETER_TEMPERATURE_REPORT_MODE_THRESHOLD,
+    WB_MSW_CONFIG_PARAMETER_HUMIDITY_REPORT_MODE_THRESHOLD,
+    WB_MSW_CONFIG_PARAMETER_LUMEN_REPORT_MODE_THRESHOLD,
+    WB_MSW_CONFIG_PARAMETER_CO2_REPORT_MODE_THRESHOLD,
+    WB_MSW_CONFIG_PARAMETER_VOC_REPORT_MODE_THRESHOLD,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_REPORT_MODE_THRESHOLD,
+
+    // Statistics over time windows
+    WB_MSW_CONFIG_PARAMETER_STATISTICS_WINDOW,
+    WB_MSW_CONFIG_PARAMETER_STATISTICS_CHANNEL,
+    WB_MSW_CONFIG_PARAMETER_STATISTICS_MINIMUM,
+    WB_MSW_CONFIG_PARAMETER_STATISTICS_MAXIMUM,
+    WB_MSW_CONFIG_PARAMETER_STATISTICS_MEAN,
+
+    // Computed channels settings
+    WB_MSW_CONFIG_PARAMETER_DEW_POINT_REPORT_THRESHOLD,
+    WB_MSW_CONFIG_PARAMETER_ABSOLUTE_HUMIDITY_REPORT_THRESHOLD,
+    WB_MSW_CONFIG_PARAMETER_AIR_QUALITY_REPORT_THRESHOLD,
+
+    // Equivalent sound level settings
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_LEQ_WINDOW,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MAXIMUM,
+    WB_MSW_CONFIG_PARAMETER_NOISE_LEVEL_MINIMUM,
+
     WB_MSW_CONFIG_PARAMETER_LAST
 } WbMswConfigParameter;
 
-#define WB_MSW_MAX_CONFIG_PARAM ((WB_MSW_CONFIG_PARAMETER_LAST - WB_MSW_CONFIG_PARAMETER_FIRST) + 1)
+#define WB_MSW_MAX_CONFIG_PARAM (WB_MSW_CONFIG_PARAMETER_LAST - WB_MSW_CONFIG_PARAMETER_FIRST)
 
 #define WB_MSW_UART_BAUD 9600
 #define WB_MSW_UART_MODE SERIAL_8N2
 #define WB_MSW_UART_RX 8 // Z-Uno receiver pin
 #define WB_MSW_UART_TX 7 // Z-uno transmitter pin
 
+#define WB_MSW_EVENT_QUEUE_SIZE 16 // Must be a power of two
+#define WB_MSW_CHANNEL_TYPES_MAX 12 // TZWAVEChannel::CHANNEL_TYPES_COUNT
+#define WB_MSW_BASIC_SET_GROUPS_MAX 7 // Channels with a Basic Set group: all but intrusion, buzzer and the computed ones
+// A report per channel and a command per group, so no entry is ever dropped
+#define WB_MSW_REPORT_QUEUE_SIZE (WB_MSW_CHANNEL_TYPES_MAX + WB_MSW_BASIC_SET_GROUPS_MAX)
+#define WB_MSW_SERVER_CHANNELS_MAX 16 // Server channel numbers start with 1
+#define WB_MSW_REPORTS_BURST 4 // Frames sent at once within the device reports rate limit, the rest of boot reports wait
+#define WB_MSW_CHANNEL_REPORTS_BURST 2 // Reports sent at once within a channel reports rate limit
+#define WB_MSW_SLOPE_WINDOW_MS 30000 // Shortest time the rate of change is measured over
+#define WB_MSW_NOISE_SAMPLE_PERIOD_MS 200 // Noise sampling period between the reads of the other channels
+#define WB_MSW_NOISE_EXTREMES_WINDOW_MS 900000 // Shortest window of Lmax and Lmin, they are kept in flash
+#define WB_MSW_STATISTICS_WINDOW_UNIT_MS 900000 // Statistics window parameter unit, the results are kept in flash
+#define WB_MSW_STATISTICS_NO_VALUE INT32_MIN // Statistics parameters value if the last window had no values
+#define WB_MSW_MOTION_SAMPLE_PERIOD_MS 200 // Motion sampling period if the sensor has no maximum register
+#define WB_MSW_HEARTBEAT_ALIGN_DIVIDER 4 // Periodic reports are sent up to 1/4 of the interval earlier to go together
+
 #define WB_MSW_UART_BOOTLOADER_BAUD 9600
 #define WB_MSW_UART_BOOTLOADER_MODE SERIAL_8N2
 
+#define WB_MSW_BOOTLOADER_TIMEOUT_MS 5000       // Time for the sensor to reboot into the bootloader
+#define WB_MSW_BOOTLOADER_POLL_PERIOD_MS 100    // Bootloader readiness poll period
+#define WB_MSW_FIRMWARE_START_TIMEOUT_MS 10000  // Time for the new firmware to start after the last block
+#define WB_MSW_FIRMWARE_BLOCK_RETRIES 3         // Write attempts per firmware block
+#define WB_MSW_FIRMWARE_UPDATE_ATTEMPTS 3       // Whole update attempts after a reset or a failed transfer
+
 typedef enum WbMswLedMode_s
 {
     WB_MSW_LED_MODE_IDLE = 0x0,
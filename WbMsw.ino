@@ -1,6 +1,7 @@
 
 #include "DebugOutput.h"
 #include "SysService.h"
+#include "TEventQueue.h"
 #include "TFWUpdater.h"
 #include "TFastModbus.h"
 #include "TWBMSWSensor.h"
@@ -28,7 +29,7 @@ ZUNO_ENABLE(
 		SKETCH_VERSION=0x010C
 		/* Firmware descriptor pointer */
 		ZUNO_EXT_FIRMWARES_DESCR_PTR=&g_OtaDesriptor
-		CONFIGPARAMETERS_MAX_COUNT=43//expands the number of parameters available
+		CONFIGPARAMETERS_MAX_COUNT=97//expands the number of parameters available
 		CERT_BUILD//Disables some config options
 		WB_MSW_CERT_BUILD_INDICATOR=100
 		MAX_PROCESSED_QUEUE_PKGS=1
@@ -56,6 +57,7 @@ TFWUpdater FwUpdater(&WbMsw);
 
 enum class TZUnoState
 {
+    ZUNO_FIRMWARE_RESUME,
     ZUNO_SCAN_ADDRESS_INITIALIZE,
     ZUNO_SCAN_ADDRESS,
     ZUNO_MODBUS_INITIALIZE,
@@ -66,6 +68,36 @@ enum class TZUnoState
 
 TZUnoState ZUnoState;
 
+// Events passed from the Z-Wave stack callbacks to the main loop
+enum class TZUnoEventType : uint8_t
+{
+    INDICATOR_OPEN,
+    INDICATOR_CLOSE,
+    SERVICE_LED_ON,
+    SERVICE_LED_OFF,
+    SOUND_SWITCH_PLAY,
+    SOUND_SWITCH_STOP,
+    OTA_IMAGE_READY
+};
+
+typedef struct
+{
+    TZUnoEventType Type;
+    uint8_t Id;     // Indicator ID
+    uint32_t Value; // LED mode or firmware size
+} TZUnoEvent;
+
+static TEventQueue<TZUnoEvent, WB_MSW_EVENT_QUEUE_SIZE> Events;
+// A new firmware image must not be lost if the queue is full, its size is kept here then, 0 - none
+static uint32_t OtaImagePendingSize = 0;
+
+// Returns false if the queue is full, the event is dropped and counted then
+static bool PushEvent(TZUnoEventType type, uint8_t id, uint32_t value)
+{
+    TZUnoEvent event = {type, id, value};
+    return Events.Push(event);
+}
+
 // ZUNO callback function return group names. "Dynamic" style is used also
 // Only those groups for which there are corresponding channels are created in the device
 const char* zunoAssociationGroupName(uint8_t groupIndex)
@@ -82,12 +114,6 @@ const ZunoCFGParameter_t* zunoCFGParameter(size_t paramNumber)
 // Static function where system events arrive
 static void SystemEvent(ZUNOSysEvent_t* ev)
 {
-    size_t i;
-    ssize_t value;
-    ssize_t defaultValue;
-    size_t paramNumber;
-    const ZunoCFGParameter_t* parameters;
-
     switch (ev->event) {
         // A new firmware image for the second chip from the Z-Wave controller has arrived
         case ZUNO_SYS_EVENT_OTA_IMAGE_READY:
@@ -95,27 +121,27 @@ static void SystemEvent(ZUNOSysEvent_t* ev)
                 DEBUG("NEW FIRMWARE AVAILABLE, SIZE=");
                 DEBUG(ev->params[1]);
                 DEBUG(" BYTES\n");
-                FwUpdater.NewFirmwareNotification(ev->params[1]);
+                if (!PushEvent(TZUnoEventType::OTA_IMAGE_READY, 0, ev->params[1])) {
+                    __atomic_store_n(&OtaImagePendingSize, ev->params[1], __ATOMIC_RELEASE);
+                }
             }
             break;
         case ZUNO_SYS_EVENT_LEARNSTATUS:
+            // The reset is done here, before the controller can send a new configuration.
+            // The configuration handler runs in this thread too, so the values have one writer
             if ((ev->params[0] == INCLUSION_STATUS_SUCESS) && (ev->params[1] == 0)) {
-                i = 0x0;
-                while (i < WB_MSW_MAX_CONFIG_PARAM) {
-                    value = zunoLoadCFGParam(i + WB_MSW_CONFIG_PARAMETER_FIRST);
-                    paramNumber = i + WB_MSW_CONFIG_PARAMETER_FIRST;
-                    parameters = ZwaveSensor.GetParameterByNumber(paramNumber);
-                    defaultValue = parameters->defaultValue;
-                    if (defaultValue != value) {
-                        zunoSaveCFGParam(paramNumber, defaultValue);
-                    }
-                    i++;
-                }
+                ZwaveSensor.ResetParameters();
             }
             break;
     }
 }
 
+// Channel handler getter: called by the Z-Wave stack when the controller requests a channel value
+static int32_t GetChannelValue(uint8_t channel)
+{
+    return ZwaveSensor.GetChannelValue(channel);
+}
+
 static void UpdateParameterValue(size_t paramNumber, int32_t value)
 {
     ZwaveSensor.SetParameterValue(paramNumber, value);
@@ -127,17 +153,59 @@ void setup()
     // Set system event handler (needed for firmware updates)
     zunoAttachSysHandler(ZUNO_HANDLER_SYSEVENT, 0, (void*)&SystemEvent);
     ZUnoState = TZUnoState::ZUNO_SCAN_ADDRESS_INITIALIZE;
+
+    // The WB sensor stays in the bootloader if the firmware update was interrupted, so it can't be found by the scan
+    uint8_t modbusAddress;
+    if (FwUpdater.RestoreProgress(modbusAddress)) {
+        WbMsw.SetModbusAddress(modbusAddress);
+        ZUnoState = TZUnoState::ZUNO_FIRMWARE_RESUME;
+    }
 }
 
 static void SoundSwitchLoop(void);
 void SendTest(uint16_t version);
 static void ServiceLedLoop(void);
+static void EventsLoop(void);
+static void FirmwareUpdateLoop(void);
 
 // Main loop
 void loop()
 {
+    EventsLoop();
 
     switch (ZUnoState) {
+        case TZUnoState::ZUNO_FIRMWARE_RESUME: {
+            static uint8_t attempts = 0;
+            if (!FwUpdater.IsUpdating()) {
+                if (!WbMsw.OpenPort(WB_MSW_UART_BAUD, WB_MSW_UART_MODE, WB_MSW_UART_RX, WB_MSW_UART_TX)) {
+                    DEBUG("*** ERROR Can't open modbus port!\n");
+                    delay(1000);
+                    break;
+                }
+                if (!FwUpdater.StartUpdate()) {
+                    WbMsw.ClosePort();
+                    attempts = 0;
+                    ZwaveSensor.SetUpdating(false);
+                    ZUnoState = TZUnoState::ZUNO_SCAN_ADDRESS_INITIALIZE;
+                    break;
+                }
+            }
+            TFWUpdater::Result result = FwUpdater.ProcessUpdate();
+            if (result == TFWUpdater::Result::FW_UPDATE_IN_PROGRESS) {
+                break;
+            }
+            WbMsw.ClosePort();
+            if (result == TFWUpdater::Result::FW_UPDATE_SUCCESS || ++attempts >= WB_MSW_FIRMWARE_UPDATE_ATTEMPTS) {
+                if (result != TFWUpdater::Result::FW_UPDATE_SUCCESS) {
+                    DEBUG("*** ERROR Firmware update failed\n");
+                    FwUpdater.CancelUpdate();
+                }
+                attempts = 0;
+                ZwaveSensor.SetUpdating(false);
+                ZUnoState = TZUnoState::ZUNO_SCAN_ADDRESS_INITIALIZE;
+            }
+            break;
+        }
         case TZUnoState::ZUNO_SCAN_ADDRESS_INITIALIZE: {
             if (FastModbus.OpenPort(WB_MSW_UART_BAUD, WB_MSW_UART_MODE, WB_MSW_UART_RX, WB_MSW_UART_TX)) {
                 ZUnoState = TZUnoState::ZUNO_SCAN_ADDRESS;
@@ -206,10 +274,12 @@ void loop()
             // We need to initialize channels before reading parameters because
             // available parameters depends of available channels.
             // Watch zunoCFGParameter() function. This feature needs for specification procedure
-            // Read channel values from WbMsw
-            if (ZwaveSensor.ChannelsInitialize()) {
+            // Read channel values from WbMsw. Endpoints are assigned anew only while the device is not included
+            if (ZwaveSensor.ChannelsInitialize(!zunoInNetwork())) {
                 // Read from FLASH configuration parameters
                 ZwaveSensor.ParametersInitialize();
+                // Don't report again the values the controller already has if it was a warm reset
+                ZwaveSensor.RestoreState();
                 // If the device is offline
                 if (zunoStartDeviceConfiguration()) {
                     // Add channels to Z-Wave interface
@@ -219,7 +289,7 @@ void loop()
                     zunoCommitCfg(); // Transfer the received configuration to the system
                 }
                 // Bind handlers for channels fields
-                ZwaveSensor.SetChannelHandlers();
+                ZwaveSensor.SetChannelHandlers((void*)&GetChannelValue);
                 // Set parameter changing event handler (needed for firmware updates)
                 zunoAttachSysHandler(ZUNO_HANDLER_ZW_CFG, 0, (void*)&UpdateParameterValue);
 
@@ -231,17 +301,22 @@ void loop()
             break;
         }
         case TZUnoState::ZUNO_POLL_CHANNELS: {
+            ZwaveSensor.ProcessReports();
+            // The sensor is in its bootloader during the firmware transfer, the Z-Wave side keeps working meanwhile
+            if (FwUpdater.IsUpdating()) {
+                FirmwareUpdateLoop();
+                break;
+            }
             if (ZwaveSensor.ProcessChannels() != TZWAVESensor::Result::ZWAVE_PROCESS_OK) {
                 WbMsw.ClosePort();
                 ZUnoState = TZUnoState::ZUNO_SCAN_ADDRESS_INITIALIZE;
                 break;
             }
 
-            // If a new firmware came on the radio, send it to the bootloder of the WB chip
-            if (FwUpdater.CheckNewFirmwareAvailable() && FwUpdater.UpdateFirmware()) {
-                uint16_t version;
-                FwUpdater.GetFirmvareVersion(version);
-                g_OtaDesriptor.version = version;
+            // If a new firmware came on the radio, send it to the bootloder of the WB chip block by block
+            if (FwUpdater.CheckNewFirmwareAvailable() && FwUpdater.StartUpdate()) {
+                ZwaveSensor.SetUpdating(true);
+                break;
             }
             SoundSwitchLoop();
             ServiceLedLoop();
@@ -317,7 +392,7 @@ static void ServiceLedLoop(void)
     msLedFreeLast = millis() + 10000;
 }
 
-void zunoIndicatorLoopOpen(uint8_t pin, uint8_t indicatorId)
+static void IndicatorOpen(uint8_t indicatorId)
 {
     switch (indicatorId) {
         case INDICATOR_ID_ARMED:
@@ -336,10 +411,9 @@ void zunoIndicatorLoopOpen(uint8_t pin, uint8_t indicatorId)
         default:
             break;
     }
-    (void)pin;
 }
 
-void zunoIndicatorLoopClose(uint8_t pin, uint8_t indicatorId)
+static void IndicatorClose(uint8_t indicatorId)
 {
     switch (indicatorId) {
         case INDICATOR_ID_ARMED:
@@ -358,6 +432,17 @@ void zunoIndicatorLoopClose(uint8_t pin, uint8_t indicatorId)
         default:
             break;
     }
+}
+
+void zunoIndicatorLoopOpen(uint8_t pin, uint8_t indicatorId)
+{
+    PushEvent(TZUnoEventType::INDICATOR_OPEN, indicatorId, 0);
+    (void)pin;
+}
+
+void zunoIndicatorLoopClose(uint8_t pin, uint8_t indicatorId)
+{
+    PushEvent(TZUnoEventType::INDICATOR_CLOSE, indicatorId, 0);
     (void)pin;
 }
 
@@ -390,7 +475,7 @@ void zunoSysServiceLedOff(uint8_t pin)
 {
     switch (pin) {
         case SYSLED_LEARN:
-            LedModeNew = WB_MSW_LED_MODE_IDLE;
+            PushEvent(TZUnoEventType::SERVICE_LED_OFF, 0, WB_MSW_LED_MODE_IDLE);
             break;
         default:
             break;
@@ -403,7 +488,7 @@ void zunoSysServiceLedOn(uint8_t pin)
         return;
     switch (pin) {
         case SYSLED_LEARN:
-            LedModeNew = LedModeSysLed;
+            PushEvent(TZUnoEventType::SERVICE_LED_ON, 0, LedModeSysLed);
             break;
         default:
             break;
@@ -494,15 +579,29 @@ static void SoundSwitchLoop(void)
     }
 }
 
+// Buzzer commands are executed in order as soon as the sensor is polled,
+// so a play quickly followed by a stop still produces a beep
+static void SoundSwitchSet(bool state)
+{
+    if (SoundSwitchStateNew != SoundSwitchStateOld) {
+        // The previous command was not applied yet
+        Events.AddCoalesced(1);
+    }
+    SoundSwitchStateNew = state;
+    if (ZUnoState == TZUnoState::ZUNO_POLL_CHANNELS && !FwUpdater.IsUpdating()) {
+        SoundSwitchLoop();
+    }
+}
+
 void zunoSoundSwitchStop(uint8_t channel)
 {
-    SoundSwitchStateNew = false;
+    PushEvent(TZUnoEventType::SOUND_SWITCH_STOP, 0, 0);
     (void)channel;
 }
 
 void zunoSoundSwitchPlay(uint8_t channel, uint8_t volume, size_t freq)
 {
-    SoundSwitchStateNew = true;
+    PushEvent(TZUnoEventType::SOUND_SWITCH_PLAY, 0, 0);
     (void)channel;
     (void)volume;
     (void)freq;
@@ -512,4 +611,75 @@ const ZunoSoundSwitchParameterArray_t* zunoSoundSwitchGetParameterArrayUser(size
 {
     return &_switch_cc_parameter_array_255;
     (void)channel;
-}
\ No newline at end of file
+}
+
+// Transfers one firmware block per loop pass. Buzzer and LED commands wait until the sensor firmware restarts
+static void FirmwareUpdateLoop(void)
+{
+    switch (FwUpdater.ProcessUpdate()) {
+        case TFWUpdater::Result::FW_UPDATE_SUCCESS: {
+            uint16_t version;
+            FwUpdater.GetFirmvareVersion(version);
+            g_OtaDesriptor.version = version;
+            ZwaveSensor.SetUpdating(false);
+            break;
+        }
+        // The sensor is probably left in its bootloader and doesn't answer the polling,
+        // so the transfer is started again from there
+        case TFWUpdater::Result::FW_UPDATE_ERROR:
+            WbMsw.ClosePort();
+            ZUnoState = TZUnoState::ZUNO_FIRMWARE_RESUME;
+            break;
+        default:
+            break;
+    }
+}
+
+// Handles events queued by the Z-Wave stack callbacks
+static void EventsLoop(void)
+{
+    static uint32_t droppedLast = 0;
+    TZUnoEvent event;
+    uint32_t ledEvents = 0;
+
+    while (Events.Pop(event)) {
+        switch (event.Type) {
+            case TZUnoEventType::INDICATOR_OPEN:
+                IndicatorOpen(event.Id);
+                ledEvents++;
+                break;
+            case TZUnoEventType::INDICATOR_CLOSE:
+                IndicatorClose(event.Id);
+                ledEvents++;
+                break;
+            case TZUnoEventType::SERVICE_LED_ON:
+            case TZUnoEventType::SERVICE_LED_OFF:
+                LedModeNew = (WbMswLedMode_t)event.Value;
+                ledEvents++;
+                break;
+            case TZUnoEventType::SOUND_SWITCH_PLAY:
+                SoundSwitchSet(true);
+                break;
+            case TZUnoEventType::SOUND_SWITCH_STOP:
+                SoundSwitchSet(false);
+                break;
+            case TZUnoEventType::OTA_IMAGE_READY:
+                FwUpdater.NewFirmwareNotification(event.Value);
+                break;
+        }
+    }
+    uint32_t otaImageSize = __atomic_exchange_n(&OtaImagePendingSize, 0, __ATOMIC_ACQ_REL);
+    if (otaImageSize) {
+        FwUpdater.NewFirmwareNotification(otaImageSize);
+    }
+    // Only the resulting LED mode is shown
+    if (ledEvents > 1) {
+        Events.AddCoalesced(ledEvents - 1);
+    }
+    if (Events.GetDropped() != droppedLast) {
+        droppedLast = Events.GetDropped();
+        DEBUG("*** ERROR Event queue overflow, dropped ");
+        DEBUG(droppedLast);
+        DEBUG(" events\n");
+    }
+}
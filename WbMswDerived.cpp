@@ -0,0 +1,50 @@
+#include "WbMswDerived.h"
+#include "WbMswFixedPoint.h"
+
+// Magnus formula coefficients (Sonntag 1990), b in Q16, c in 0.01 C
+#define WB_MSW_MAGNUS_B 1154744 // 17.62
+#define WB_MSW_MAGNUS_C 24312   // 243.12 C
+// Saturation vapour pressure coefficients (Bolton 1980)
+#define WB_MSW_VAPOUR_B 1158021 // 17.67 in Q16
+#define WB_MSW_VAPOUR_C 24350   // 243.5 C
+#define WB_MSW_VAPOUR_E0 6112   // 6.112 hPa
+#define WB_MSW_LOG2_E 94548     // log2(e) in Q16
+
+// Sub-indices by the indoor air quality classes: CO2 above the outdoor level (EN 16798-1 categories),
+// TVOC by the German Environment Agency (UBA) levels
+static const WbMswFixedPoint_t Co2Index[] = {{400, 0}, {800, 50}, {1000, 100}, {1400, 150}, {2000, 200}, {5000, 300}};
+static const WbMswFixedPoint_t VocIndex[] = {{0, 0}, {220, 50}, {660, 100}, {2200, 150}, {5500, 200}, {10000, 300}};
+
+static int32_t ClampHumidity(int32_t humidity)
+{
+    if (humidity < 1) {
+        return 1;
+    }
+    return humidity > 10000 ? 10000 : humidity;
+}
+
+int32_t WbMswDewPoint(int32_t temperature, int32_t humidity)
+{
+    // gamma = ln(RH) + b * T / (c + T), Td = c * gamma / (b - gamma)
+    int64_t lnHumidity = (int64_t)(WbMswFixedLog2(ClampHumidity(humidity)) - WbMswFixedLog2(10000)) *
+                         WB_MSW_FIXED_POINT_LN2 / WB_MSW_FIXED_POINT_ONE;
+    int64_t gamma = lnHumidity + (int64_t)WB_MSW_MAGNUS_B * temperature / (WB_MSW_MAGNUS_C + temperature);
+    return (int32_t)(WB_MSW_MAGNUS_C * gamma / (WB_MSW_MAGNUS_B - gamma));
+}
+
+int32_t WbMswAbsoluteHumidity(int32_t temperature, int32_t humidity)
+{
+    // e = RH * 6.112 * exp(b * T / (c + T)) hPa, AH = 216.7 * e / (273.15 + T) g/m3
+    int64_t power = (int64_t)WB_MSW_VAPOUR_B * temperature / (WB_MSW_VAPOUR_C + temperature);
+    int64_t saturation = (int64_t)WB_MSW_VAPOUR_E0 * WbMswFixedExp2(power * WB_MSW_LOG2_E / WB_MSW_FIXED_POINT_ONE) /
+                         WB_MSW_FIXED_POINT_ONE; // 0.001 hPa
+    int64_t pressure = saturation * ClampHumidity(humidity) / 10000;
+    return (int32_t)(2167 * pressure / (27315 + temperature));
+}
+
+int32_t WbMswAirQualityIndex(int32_t co2, int32_t voc)
+{
+    int32_t co2Index = WbMswInterpolate(Co2Index, sizeof(Co2Index) / sizeof(Co2Index[0]), co2);
+    int32_t vocIndex = WbMswInterpolate(VocIndex, sizeof(VocIndex) / sizeof(VocIndex[0]), voc);
+    return co2Index > vocIndex ? co2Index : vocIndex;
+}
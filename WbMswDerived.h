@@ -0,0 +1,16 @@
+#ifndef WB_MSW_DERIVED_H
+#define WB_MSW_DERIVED_H
+
+#include <stdint.h>
+
+// Values computed from the values of other sensors, in integer math.
+// temperature - 0.01 C, humidity - 0.01 %RH, co2 - ppm, voc - ppb
+
+// Magnus formula, 0.01 C
+int32_t WbMswDewPoint(int32_t temperature, int32_t humidity);
+// Water vapour density, 0.01 g/m3
+int32_t WbMswAbsoluteHumidity(int32_t temperature, int32_t humidity);
+// 0 (excellent) ... 300 (unhealthy), the worse of the CO2 and VOC sub-indices
+int32_t WbMswAirQualityIndex(int32_t co2, int32_t voc);
+
+#endif // WB_MSW_DERIVED_H
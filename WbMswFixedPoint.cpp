@@ -0,0 +1,62 @@
+#include "WbMswFixedPoint.h"
+
+#define WB_MSW_FIXED_POINT_TABLE_BITS 4 // 16 intervals per octave
+
+// log2(1 + i / 16) in Q16
+static const uint32_t Log2Table[(1 << WB_MSW_FIXED_POINT_TABLE_BITS) + 1] = {
+    0,     5732,  11136, 16248, 21098, 25711, 30109, 34312, 38336,
+    42196, 45904, 49472, 52911, 56229, 59434, 62534, 65536};
+
+// 2^(i / 16) in Q16
+static const uint32_t Exp2Table[(1 << WB_MSW_FIXED_POINT_TABLE_BITS) + 1] = {
+    65536, 68438,  71468,  74632,  77936,  81386,  84990,  88752, 92682,
+    96785, 101070, 105545, 110218, 115098, 120194, 125515, 131072};
+
+int32_t WbMswFixedLog2(uint32_t value)
+{
+    if (value == 0) {
+        return INT32_MIN;
+    }
+    int32_t exponent = 31 - __builtin_clz(value);
+    // Mantissa in Q16 within [1, 2)
+    uint32_t mantissa = exponent >= 16 ? value >> (exponent - 16) : value << (16 - exponent);
+    uint32_t fraction = mantissa - WB_MSW_FIXED_POINT_ONE;
+    uint8_t index = fraction >> (16 - WB_MSW_FIXED_POINT_TABLE_BITS);
+    uint32_t rest = fraction & ((1 << (16 - WB_MSW_FIXED_POINT_TABLE_BITS)) - 1);
+    int32_t low = Log2Table[index];
+    int32_t high = Log2Table[index + 1];
+    return (exponent << 16) + low + (((high - low) * (int32_t)rest) >> (16 - WB_MSW_FIXED_POINT_TABLE_BITS));
+}
+
+uint32_t WbMswFixedExp2(int32_t power)
+{
+    int32_t exponent = power >> 16; // Floor, also for negative powers
+    uint32_t fraction = power & 0xFFFF;
+    if (exponent >= 16) {
+        return UINT32_MAX;
+    }
+    if (exponent < -17) {
+        return 0;
+    }
+    uint8_t index = fraction >> (16 - WB_MSW_FIXED_POINT_TABLE_BITS);
+    uint32_t rest = fraction & ((1 << (16 - WB_MSW_FIXED_POINT_TABLE_BITS)) - 1);
+    uint32_t low = Exp2Table[index];
+    uint32_t high = Exp2Table[index + 1];
+    uint32_t mantissa = low + (((high - low) * rest) >> (16 - WB_MSW_FIXED_POINT_TABLE_BITS));
+    return exponent >= 0 ? mantissa << exponent : mantissa >> -exponent;
+}
+
+int32_t WbMswInterpolate(const WbMswFixedPoint_t* points, uint8_t count, int32_t x)
+{
+    if (x <= points[0].X) {
+        return points[0].Y;
+    }
+    for (uint8_t i = 1; i < count; i++) {
+        if (x <= points[i].X) {
+            const WbMswFixedPoint_t& low = points[i - 1];
+            const WbMswFixedPoint_t& high = points[i];
+            return low.Y + (int32_t)((int64_t)(high.Y - low.Y) * (x - low.X) / (high.X - low.X));
+        }
+    }
+    return points[count - 1].Y;
+}
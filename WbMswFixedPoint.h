@@ -0,0 +1,24 @@
+#ifndef WB_MSW_FIXED_POINT_H
+#define WB_MSW_FIXED_POINT_H
+
+#include <stdint.h>
+
+// Q16 fixed point math on lookup tables with linear interpolation, the relative error is about 0.1%
+#define WB_MSW_FIXED_POINT_ONE 65536 // 1.0 in Q16
+#define WB_MSW_FIXED_POINT_LN2 45426 // ln(2) in Q16
+
+// log2(value) in Q16, value > 0
+int32_t WbMswFixedLog2(uint32_t value);
+// 2^power in Q16, power in Q16. Saturates at UINT32_MAX for power >= 16
+uint32_t WbMswFixedExp2(int32_t power);
+
+// Piecewise linear function given by points with increasing x
+struct WbMswFixedPoint_t
+{
+    int32_t X;
+    int32_t Y;
+};
+// Values outside of the points take the value of the nearest end
+int32_t WbMswInterpolate(const WbMswFixedPoint_t* points, uint8_t count, int32_t x);
+
+#endif // WB_MSW_FIXED_POINT_H
@@ -0,0 +1,32 @@
+#ifndef WB_MSW_IMAGE_H
+#define WB_MSW_IMAGE_H
+
+#include "THeatshrinkDecoder.h"
+#include <stdint.h>
+
+// OTA image of the WB sensor firmware. It is either a raw .wbfw file (info block followed by data blocks)
+// or the same file prepended by the header below (see tools/wbmsw_image.py).
+// All fields are little endian
+#define WB_MSW_IMAGE_MAGIC 0x494D5357 // "WSMI"
+#define WB_MSW_IMAGE_FORMAT 2
+
+#define WB_MSW_IMAGE_COMPRESSION_NONE 0
+#define WB_MSW_IMAGE_COMPRESSION_HEATSHRINK 1 // Flags keep the lookahead bits << 4 | window bits
+#define WB_MSW_IMAGE_HEATSHRINK_FLAGS (HEATSHRINK_LOOKAHEAD_BITS << 4 | HEATSHRINK_WINDOW_BITS)
+
+typedef struct
+{
+    uint32_t Magic;
+    uint8_t Format;      // Header format version
+    uint8_t Compression; // WB_MSW_IMAGE_COMPRESSION_*
+    uint16_t Flags;
+    uint32_t PayloadSize; // Bytes following the header
+    uint32_t ImageSize;   // Bytes of the .wbfw file (unpacked)
+    uint16_t Version;     // Firmware version in the file (major << 8 | minor), 0 if unknown
+    uint16_t PayloadCrc;  // CRC16 (modbus) of the payload
+    uint16_t HeaderCrc;   // CRC16 (modbus) of the previous header fields
+} __attribute__((packed)) WbMswImageHeader_t;
+
+static_assert(sizeof(WbMswImageHeader_t) % sizeof(uint16_t) == 0, "Payload must be word aligned");
+
+#endif // WB_MSW_IMAGE_H
@@ -0,0 +1,50 @@
+#ifndef WB_MSW_RETENTION_H
+#define WB_MSW_RETENTION_H
+
+#include "em_rtcc.h"
+
+// RTCC retention registers keep their values across Z-Uno resets (but not across power loss).
+// The sketch assumes the Z-Uno core keeps its reset state (zunoRSTRetention()) in the lower half of the registers,
+// as the core 03.00.12 beta05 pinned in the Makefile and Dockerfile does. Recheck this on a core upgrade.
+// Registers used by the sketch:
+//  16-28 - reported channels state,
+//  29-31 - WB sensor firmware update progress
+#define WB_MSW_RETENTION_REGISTERS_COUNT 32
+#define WB_MSW_RETENTION_SKETCH_FIRST 16
+
+// Channels state reported to the controller, restored after a warm reset to avoid repeated reports
+#define WB_MSW_RETENTION_CHANNELS_VALUES 16          // One register per channel type
+#define WB_MSW_RETENTION_CHANNELS_FLAGS 25           // Reported (bits 0-15), triggered (bits 16-29), wait off flags
+#define WB_MSW_RETENTION_CHANNELS_MOTION_TIMER 26    // Motion wait off time left, ms
+#define WB_MSW_RETENTION_CHANNELS_INTRUSION_TIMER 27 // Intrusion wait off time left, ms
+#define WB_MSW_RETENTION_CHANNELS_CHECK 28           // WB_MSW_RETENTION_CHANNELS_MAGIC << 16 | CRC16 of the above
+#define WB_MSW_RETENTION_CHANNELS_MAGIC 0x5743 // "WC"
+#define WB_MSW_RETENTION_FLAG_MOTION_WAIT_OFF (1UL << 30)
+#define WB_MSW_RETENTION_FLAG_INTRUSION_WAIT_OFF (1UL << 31)
+
+// Firmware update progress
+#define WB_MSW_RETENTION_FW_STATE 29 // WB_MSW_RETENTION_FW_MAGIC << 8 | modbus address
+#define WB_MSW_RETENTION_FW_SIZE 30
+#define WB_MSW_RETENTION_FW_BLOCK 31
+#define WB_MSW_RETENTION_FW_MAGIC 0x574246 // "WBF"
+
+static_assert(WB_MSW_RETENTION_CHANNELS_VALUES == WB_MSW_RETENTION_SKETCH_FIRST,
+              "Retention registers below WB_MSW_RETENTION_SKETCH_FIRST belong to the core");
+static_assert(WB_MSW_RETENTION_CHANNELS_CHECK < WB_MSW_RETENTION_FW_STATE,
+              "Channels state and firmware update progress registers overlap");
+static_assert(WB_MSW_RETENTION_FW_STATE < WB_MSW_RETENTION_FW_SIZE &&
+                  WB_MSW_RETENTION_FW_SIZE < WB_MSW_RETENTION_FW_BLOCK &&
+                  WB_MSW_RETENTION_FW_BLOCK < WB_MSW_RETENTION_REGISTERS_COUNT,
+              "Firmware update progress registers are out of range");
+
+inline uint32_t WbMswRetentionGet(uint8_t index)
+{
+    return RTCC_RetentionRegisterGet(index);
+}
+
+inline void WbMswRetentionSet(uint8_t index, uint32_t value)
+{
+    RTCC_RetentionRegisterSet(index, value);
+}
+
+#endif // WB_MSW_RETENTION_H
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Packs a WB-MSW .wbfw firmware file into an OTA image for the Z-Wave sketch.
+
+The image is the .wbfw file prepended by a header with its size and CRC (see WbMswImage.h),
+so the sketch can check the image before the sensor is switched to the bootloader.
+With --compress the .wbfw file is packed in the heatshrink format (see THeatshrinkDecoder.h),
+the sketch unpacks it on the fly while sending it to the sensor.
+"""
+
+import argparse
+import struct
+import sys
+
+IMAGE_MAGIC = 0x494D5357  # "WSMI"
+IMAGE_FORMAT = 2
+COMPRESSION_NONE = 0
+COMPRESSION_HEATSHRINK = 1
+
+HEATSHRINK_WINDOW_BITS = 8
+HEATSHRINK_LOOKAHEAD_BITS = 4
+HEATSHRINK_MIN_MATCH = 2  # A back reference is shorter than two literals
+
+FIRMWARE_INFO_SIZE = 32
+FIRMWARE_DATA_SIZE = 136
+
+HEADER_FORMAT = "<IBBHIIHH"
+
+
+def crc16_modbus(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            if crc & 1:
+                crc = (crc >> 1) ^ 0xA001
+            else:
+                crc >>= 1
+    return crc
+
+
+class BitWriter:
+    def __init__(self):
+        self.data = bytearray()
+        self.bits = 0
+        self.count = 0
+
+    def put(self, value, count):
+        for i in reversed(range(count)):
+            self.bits = (self.bits << 1) | ((value >> i) & 1)
+            self.count += 1
+            if self.count == 8:
+                self.data.append(self.bits)
+                self.bits = 0
+                self.count = 0
+
+    def flush(self):
+        if self.count:
+            self.data.append(self.bits << (8 - self.count))
+            self.bits = 0
+            self.count = 0
+        return bytes(self.data)
+
+
+def heatshrink_compress(data):
+    """Greedy LZSS encoder producing the heatshrink bit stream"""
+    window = 1 << HEATSHRINK_WINDOW_BITS
+    lookahead = 1 << HEATSHRINK_LOOKAHEAD_BITS
+    positions = {}  # Two byte prefix -> positions where it occurs
+    writer = BitWriter()
+    pos = 0
+    while pos < len(data):
+        best_length = 0
+        best_offset = 0
+        prefix = data[pos : pos + HEATSHRINK_MIN_MATCH]
+        for candidate in reversed(positions.get(prefix, [])):
+            offset = pos - candidate
+            if offset > window:
+                break
+            length = 0
+            limit = min(lookahead, len(data) - pos)
+            # Overlapping references are fine, the decoder copies byte by byte
+            while length < limit and data[candidate + length] == data[pos + length]:
+                length += 1
+            if length > best_length:
+                best_length = length
+                best_offset = offset
+                if length == limit:
+                    break
+        if best_length >= HEATSHRINK_MIN_MATCH:
+            writer.put(0, 1)
+            writer.put(best_offset - 1, HEATSHRINK_WINDOW_BITS)
+            writer.put(best_length - 1, HEATSHRINK_LOOKAHEAD_BITS)
+            step = best_length
+        else:
+            writer.put(1, 1)
+            writer.put(data[pos], 8)
+            step = 1
+        for i in range(pos, pos + step):
+            key = data[i : i + HEATSHRINK_MIN_MATCH]
+            chain = positions.setdefault(key, [])
+            chain.append(i)
+            if len(chain) > window:
+                del chain[0]
+        pos += step
+    return writer.flush()
+
+
+def parse_version(text):
+    """Packs "major.minor[.patch]" the way the sketch reads the version from the sensor"""
+    parts = text.split(".")
+    try:
+        major, minor = int(parts[0]), int(parts[1])
+    except (IndexError, ValueError):
+        raise ValueError("wrong firmware version %s" % text)
+    if not (0 <= major <= 255 and 0 <= minor <= 255) or (major, minor) == (0, 0):
+        raise ValueError("wrong firmware version %s" % text)
+    return major << 8 | minor
+
+
+def pack(firmware, compress=False, version=0):
+    if len(firmware) < FIRMWARE_INFO_SIZE or (len(firmware) - FIRMWARE_INFO_SIZE) % FIRMWARE_DATA_SIZE:
+        raise ValueError("wrong .wbfw file size %d" % len(firmware))
+    if compress:
+        payload = heatshrink_compress(firmware)
+        compression = COMPRESSION_HEATSHRINK
+        flags = HEATSHRINK_LOOKAHEAD_BITS << 4 | HEATSHRINK_WINDOW_BITS
+    else:
+        payload = firmware
+        compression = COMPRESSION_NONE
+        flags = 0
+    # The payload is read by words
+    if len(payload) % 2:
+        payload += b"\0"
+    header = struct.pack(
+        HEADER_FORMAT,
+        IMAGE_MAGIC,
+        IMAGE_FORMAT,
+        compression,
+        flags,
+        len(payload),
+        len(firmware),
+        version,
+        crc16_modbus(payload),
+    )
+    header += struct.pack("<H", crc16_modbus(header))
+    return header + payload
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("input", help=".wbfw firmware file")
+    parser.add_argument("output", help="OTA image file")
+    parser.add_argument("--compress", action="store_true", help="pack the firmware in the heatshrink format")
+    parser.add_argument(
+        "--version", help="firmware version in the file (major.minor), the sketch checks it after the update"
+    )
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        firmware = f.read()
+    try:
+        version = parse_version(args.version) if args.version else 0
+        image = pack(firmware, args.compress, version)
+    except ValueError as e:
+        sys.exit("error: %s" % e)
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print("%s: %d -> %d bytes" % (args.output, len(firmware), len(image)))
+
+
+if __name__ == "__main__":
+    main()